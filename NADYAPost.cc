@@ -0,0 +1,282 @@
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glob.h>
+
+#include "InfoFile.hh"
+#include "JobMerge.hh"
+#include "PostProcessing.hh"
+
+// Batch post-processing of finished runs:
+//   NADYAPost [-j N] [--force] [--export-format csv|binary|both] [--bootstrap N]
+//             <info_*.txt | run.root | glob> ...
+//   NADYAPost --merge <merged_info.txt> <info_*_jobN.txt | glob> ...
+
+namespace fs = std::filesystem;
+
+struct Job {
+    std::string infoPath;
+    PostProcessingSettings settings;
+    bool isotropic = true;
+};
+
+static std::vector<std::string> Expand(const std::string& pattern) {
+    std::vector<std::string> out;
+    glob_t g{};
+    if (glob(pattern.c_str(), 0, nullptr, &g) == 0) {
+        for (size_t i = 0; i < g.gl_pathc; ++i) out.emplace_back(g.gl_pathv[i]);
+    }
+    globfree(&g);
+    return out;
+}
+
+// Same mapping as Loader::ReadFlux, from the Flux_type / Flux_params entries of the info file.
+static void ReadFlux(const InfoFile& info, const fs::path& base, PostProcessingSettings& s) {
+    const std::string type = info.GetOr("Flux_type", "");
+    auto& fp = s.fluxParams;
+    s.hasFlux = true;
+
+    // Loader integrates the flux over the flux-config energy range, listed first in Energies: "(Emin, Emax)".
+    s.fluxRange = {s.eMinMeV, s.eMaxMeV};
+    for (const auto& key : info.Keys()) {
+        if (key.rfind("Energies.", 0) != 0) continue;
+        std::string range = info.Get(key);
+        range.erase(std::remove_if(range.begin(), range.end(), [](char c) { return c == '(' || c == ')'; }),
+                    range.end());
+        if (const auto comma = range.find(','); comma != std::string::npos) {
+            s.fluxRange = {std::stod(range.substr(0, comma)), std::stod(range.substr(comma + 1))};
+        }
+        break;
+    }
+
+    if (type == "PLAW" || type == "COMP") {
+        s.fluxType = type == "PLAW" ? FluxType::PLAW : FluxType::COMP;
+        fp.A = info.GetDouble("Flux_params.A");
+        fp.alpha = info.GetDouble("Flux_params.alpha");
+        fp.E_piv = info.GetDouble("Flux_params.E_Piv");
+        if (type == "COMP") fp.E_peak = info.GetDouble("Flux_params.E_Peak");
+    } else if (type == "SEP") {
+        s.fluxType = FluxType::SEP;
+        fp.sep_year = info.GetInt("Flux_params.year");
+        fp.sep_order = info.GetInt("Flux_params.order");
+        fp.sep_csv_path = (base / "../SEP_coefficients.CSV").string();
+    } else if (type == "Galactic") {
+        s.fluxType = FluxType::GALACTIC;
+        fp.phiMV = info.GetDouble("Flux_params.phiMV");
+        fp.particle = info.Get("Flux_params.particle");
+    } else if (type == "Table") {
+        s.fluxType = FluxType::TABLE;
+        fs::path table = info.Get("Flux_params.table_path");
+        if (table.is_relative()) table = base / table;
+        fp.table_path = table.string();
+        fp.particle = info.Get("Flux_params.particle");
+    } else if (type == "Uniform") {
+        s.fluxType = FluxType::UNIFORM;
+    } else {
+        s.hasFlux = false;
+    }
+}
+
+static Job MakeJob(const std::string& infoPath) {
+    const InfoFile info(infoPath);
+    const fs::path base = fs::path(infoPath).parent_path();
+
+    Job job;
+    job.infoPath = infoPath;
+    auto& s = job.settings;
+
+    fs::path rootPath = info.Get("Post_processing.Output_file");
+    if (rootPath.is_relative()) rootPath = base / rootPath;
+    s.outputFile = rootPath.lexically_normal().string();
+    s.outputFolderName = info.Get("Post_processing.Run_folder");
+    s.particle = info.GetOr("Post_processing.Particle", "");
+    s.eMinMeV = info.GetDouble("Post_processing.E_min");
+    s.eMaxMeV = info.GetDouble("Post_processing.E_max");
+    s.eCrystalThresholdMeV = info.GetDouble("Post_processing.Crystal_threshold");
+    s.nBins = info.GetInt("Post_processing.Bins");
+    s.useOptics = info.GetBool("Use_optics");
+    s.saveSecondaries = info.GetBool("Post_processing.Save_secondaries");
+    s.savePhotons = info.GetBool("Post_processing.Save_photons");
+    s.mergeNtuples = info.GetBool("Post_processing.Merge_ntuples");
+    s.asyncOutput = info.GetOr("Post_processing.Async_output", "0") == "1";
+    s.ntupleThreads = std::stoi(info.GetOr("Post_processing.Threads", "0"));
+    s.exportFormat = info.GetOr("Post_processing.Export_format", "csv");
+    s.areaCm2 = std::stod(info.GetOr("Post_processing.Area", "0"));
+    s.bootstrapReplicas = std::stoi(info.GetOr("Post_processing.Bootstrap", "0"));
+    s.bootstrapSeed = std::stoull(info.GetOr("Post_processing.Bootstrap_seed", "1"));
+    s.infoFile = infoPath;
+    s.histories = std::stoll(info.GetOr("N", "0"));
+    ReadFlux(info, base, s);
+    job.isotropic = info.GetOr("Flux_dir", "isotropic").find("isotropic") != std::string::npos;
+    return job;
+}
+
+// A ROOT file given directly is matched to the info file next to it that names it.
+static std::string InfoForRoot(const std::string& rootPath) {
+    const fs::path target = fs::absolute(rootPath).lexically_normal();
+    const fs::path dir = target.parent_path();
+    for (const auto& candidate : Expand((dir / "info_*.txt").string())) {
+        try {
+            if (fs::absolute(MakeJob(candidate).settings.outputFile).lexically_normal() == target) {
+                return candidate;
+            }
+        }
+        catch (const std::exception&) {
+        }
+    }
+    throw std::runtime_error("No info file found for " + rootPath);
+}
+
+static fs::path StampPath(const Job& job) {
+    return fs::path(PostProcessing::RunDirFor(job.settings)) / ".done";
+}
+
+static bool UpToDate(const Job& job) {
+    const fs::path stamp = StampPath(job);
+    if (!fs::exists(stamp)) return false;
+
+    std::vector<std::string> inputs = {job.infoPath, job.settings.outputFile};
+    const auto threads = PostProcessing::NtupleFiles(job.settings);
+    inputs.insert(inputs.end(), threads.begin(), threads.end());
+
+    const auto stampTime = fs::last_write_time(stamp);
+    for (const auto& in : inputs) {
+        if (fs::exists(in) && fs::last_write_time(in) > stampTime) return false;
+    }
+    return true;
+}
+
+static void Process(const Job& job) {
+    PostProcessing postProcessing(job.settings);
+
+    postProcessing.ExtractNtData();
+    if (job.settings.eMinMeV < job.settings.eMaxMeV) {
+        if (job.isotropic)
+            postProcessing.SaveSensitivity();
+        else
+            postProcessing.SaveEffArea();
+    }
+    postProcessing.SaveEventCsvs();
+
+    std::ofstream(StampPath(job)) << job.infoPath << "\n";
+}
+
+int main(int argc, char** argv) {
+    unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+    bool force = false;
+    std::string exportFormat;
+    int bootstrap = -1;
+    std::string mergedInfo;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::string input(argv[i]); (input == "-j" || input == "--jobs") && i + 1 < argc) {
+            jobs = std::max(1, std::stoi(argv[++i]));
+        } else if (input == "--force") {
+            force = true;
+        } else if (input == "--export-format" && i + 1 < argc) {
+            exportFormat = argv[++i];
+        } else if (input == "--bootstrap" && i + 1 < argc) {
+            bootstrap = std::max(0, std::stoi(argv[++i]));
+        } else if (input == "--merge" && i + 1 < argc) {
+            mergedInfo = argv[++i];
+        } else {
+            auto matched = Expand(input);
+            if (matched.empty()) {
+                std::cerr << "No match: " << input << "\n";
+            }
+            inputs.insert(inputs.end(), matched.begin(), matched.end());
+        }
+    }
+
+    if (!exportFormat.empty() && exportFormat != "csv" && exportFormat != "binary" && exportFormat != "both") {
+        std::cerr << "Unknown export format: " << exportFormat << ". Available formats: csv, binary, both\n";
+        return 1;
+    }
+
+    // Merging only combines the jobs; the merged info file is post-processed by a later call.
+    if (!mergedInfo.empty()) {
+        try {
+            std::vector<JobMerge::Input> parts;
+            for (const auto& in : inputs) {
+                const std::string infoPath = fs::path(in).extension() == ".root" ? InfoForRoot(in) : in;
+                parts.push_back({infoPath, MakeJob(infoPath).settings});
+            }
+            JobMerge(std::move(parts)).Write(mergedInfo);
+            std::cout << "Merged " << inputs.size() << " jobs into " << mergedInfo << "\n";
+            return 0;
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    std::vector<Job> queue;
+    std::set<std::string> runDirs;
+    int failures = 0;
+    for (const auto& in : inputs) {
+        try {
+            const std::string infoPath = fs::path(in).extension() == ".root" ? InfoForRoot(in) : in;
+            Job job = MakeJob(infoPath);
+            if (!exportFormat.empty()) job.settings.exportFormat = exportFormat;
+            if (bootstrap >= 0) job.settings.bootstrapReplicas = bootstrap;
+            if (!force && UpToDate(job)) {
+                std::cout << "Up to date: " << infoPath << "\n";
+                continue;
+            }
+            if (!runDirs.insert(PostProcessing::RunDirFor(job.settings)).second) {
+                std::cerr << "Skipped: " << infoPath << " writes to the same output folder as an earlier input\n";
+                continue;
+            }
+            queue.push_back(std::move(job));
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << in << ": " << e.what() << "\n";
+            ++failures;
+        }
+    }
+
+    if (queue.empty()) return failures ? 1 : 0;
+
+    const unsigned workers = std::min<unsigned>(jobs, queue.size());
+    const unsigned threadsPerJob = std::max(1u, std::thread::hardware_concurrency() / workers);
+    for (auto& job : queue) job.settings.threads = threadsPerJob;
+
+    ROOT::EnableThreadSafety();
+    // One implicit-MT pool is shared by all concurrent jobs, so it gets the whole -j budget once.
+    if (workers * threadsPerJob > 1) ROOT::EnableImplicitMT(workers * threadsPerJob);
+
+    std::atomic<std::size_t> next{0};
+    std::atomic<int> failed{0};
+    std::mutex logMutex;
+
+    auto worker = [&]() {
+        for (std::size_t i = next++; i < queue.size(); i = next++) {
+            const Job& job = queue[i];
+            try {
+                Process(job);
+                std::lock_guard lock(logMutex);
+                std::cout << "Done: " << job.infoPath << "\n";
+            }
+            catch (const std::exception& e) {
+                ++failed;
+                std::lock_guard lock(logMutex);
+                std::cerr << "Error: " << job.infoPath << ": " << e.what() << "\n";
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers);
+    for (unsigned w = 0; w < workers; ++w) pool.emplace_back(worker);
+    for (auto& t : pool) t.join();
+
+    return failures + failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,37 @@
+#!/usr/bin/env bash
+# EM physics validation: option4 everywhere vs option4 only in the Calorimeter and Fibers regions.
+# Prints events/s for both setups and compares their effective-area curves bin by bin.
+#   benchmark/run_em_benchmark.sh <path/to/NADYA> [threads] [events] [particle]
+set -euo pipefail
+
+nadya=$(realpath "$1")
+threads=${2:-1}
+events=${3:-200000}
+particle=${4:-e-}
+here=$(cd "$(dirname "$0")" && pwd)
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+mkdir -p "$work/Flux_config"
+cat > "$work/Flux_config/Uniform_params.txt" <<CFG
+particles: $particle
+fractions: 1.
+
+E_min: 1
+E_max: 1000
+CFG
+sed "s|/run/beamOn .*|/run/beamOn $events|" "$here/mip_protons.mac" > "$work/run.mac"
+
+for mode in opt4 regional; do
+    mkdir -p "$work/$mode"
+    (cd "$work/$mode" && "$nadya" -i ../run.mac -noUI -t "$threads" -f Uniform -fd isotropic --bins 30 \
+        --em-physics "$mode" --benchmark --scan-veto 0 -o "bench_$mode" | grep "^Benchmark")
+done
+
+# Columns: E_MeV, Veto_0. Bins with no triggers in either run are skipped.
+paste -d, "$work"/opt4/threshold_scan_effarea_*.csv "$work"/regional/threshold_scan_effarea_*.csv |
+    awk -F, 'NR == 1 { printf "%12s %14s %14s %10s\n", "E_MeV", "Aeff_opt4", "Aeff_regional", "rel_diff"; next }
+             { d = ($2 + $4 > 0) ? 2 * ($4 - $2) / ($2 + $4) : 0
+               if ($2 + $4 > 0) { n++; s += d; if (d > m || -d > m) m = (d < 0 ? -d : d) }
+               printf "%12.4g %14.6g %14.6g %10.4f\n", $1, $2, $4, d }
+             END { if (n) printf "bins compared: %d, mean rel diff: %.4f, max |rel diff|: %.4f\n", n, s / n, m }'
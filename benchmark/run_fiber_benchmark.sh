@@ -0,0 +1,72 @@
+#!/usr/bin/env bash
+# Navigation benchmark for the TOF fiber planes: steps/s for vertical ~MIP protons (2 GeV)
+# with per-fiber placements and with parameterised planes. Both runs use the same seed; the
+# benchmark lines are only printed once their per-fiber edep sums agree within the tolerance.
+#   benchmark/run_fiber_benchmark.sh <path/to/NADYA> [threads] [events] [tolerance]
+set -euo pipefail
+
+nadya=$(realpath "$1")
+threads=${2:-1}
+events=${3:-20000}
+tolerance=${4:-1e-9}
+seed=12345
+here=$(cd "$(dirname "$0")" && pwd)
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+mkdir -p "$work/Flux_config" "$work/run"
+cat > "$work/Flux_config/Uniform_params.txt" <<CFG
+particles: proton
+fractions: 1.
+
+E_min: 2000
+E_max: 2000
+CFG
+sed "s|/run/beamOn .*|/run/beamOn $events|" "$here/mip_protons.mac" > "$work/run.mac"
+
+# Weighted edep sum per fiber: plane module layer fiberIndex edep_MeV
+cat > "$work/fiber_sums.C" <<'MACRO'
+void fiber_sums(const char* files) {
+    TChain chain("fiber_hits");
+    chain.Add(files);
+    Int_t plane, module, layer, fiber;
+    Double_t edep, weight;
+    chain.SetBranchAddress("plane", &plane);
+    chain.SetBranchAddress("module", &module);
+    chain.SetBranchAddress("layer", &layer);
+    chain.SetBranchAddress("fiberIndex", &fiber);
+    chain.SetBranchAddress("edep_MeV", &edep);
+    chain.SetBranchAddress("weight", &weight);
+    std::map<std::tuple<int, int, int, int>, double> sums;
+    for (Long64_t i = 0; i < chain.GetEntries(); ++i) {
+        chain.GetEntry(i);
+        sums[{plane, module, layer, fiber}] += edep * weight;
+    }
+    for (const auto& [key, sum] : sums) {
+        const auto& [p, m, l, f] = key;
+        printf("fiber %d %d %d %d %.17g\n", p, m, l, f, sum);
+    }
+}
+MACRO
+
+cd "$work/run"
+for placement in placement parameterised; do
+    "$nadya" -i ../run.mac -noUI -t "$threads" -f Uniform -fd vertical_down --seed "$seed" \
+        --fiber-placement "$placement" --benchmark -o "bench_$placement" | grep "^Benchmark" > "bench_$placement.txt"
+    root -l -b -q "$work/fiber_sums.C(\"bench_$placement*.root\")" | grep "^fiber " > "sums_$placement.txt"
+done
+
+# Same fibers hit, and |a - b| <= tolerance * max(|a|, |b|) for each of them.
+awk -v tol="$tolerance" '
+    function abs(x) { return x < 0 ? -x : x }
+    NR == FNR { a[$2 " " $3 " " $4 " " $5] = $6; next }
+    { k = $2 " " $3 " " $4 " " $5; seen[k] = 1; n++
+      x = (k in a) ? a[k] : 0; m = abs(x) > abs($6) ? abs(x) : abs($6)
+      if (abs(x - $6) > tol * m) { printf "fiber %s: placement %.10g MeV, parameterised %.10g MeV\n", k, x, $6; bad++ } }
+    END { for (k in a) if (!(k in seen)) { printf "fiber %s: placement %.10g MeV, parameterised 0 MeV\n", k, a[k]; bad++ }
+          if (bad) { printf "%d fibers differ between the fiber modes; benchmark numbers not comparable\n", bad; exit 1 }
+          if (!n) { print "no fiber hits in the parameterised run"; exit 1 }
+          printf "per-fiber edep sums agree for %d fibers\n", n }' \
+    sums_placement.txt sums_parameterised.txt >&2
+
+cat bench_placement.txt bench_parameterised.txt
@@ -0,0 +1,37 @@
+#!/usr/bin/env bash
+# Field propagation benchmark: steps/s for vertical protons (default 500 MeV) without a field and with
+# a 0.5 T transverse field at each accuracy preset, uniform and as a tabulated map of the same field.
+#   benchmark/run_field_benchmark.sh <path/to/NADYA> [threads] [events] [E_MeV]
+set -euo pipefail
+
+nadya=$(realpath "$1")
+threads=${2:-1}
+events=${3:-20000}
+energy=${4:-500}
+here=$(cd "$(dirname "$0")" && pwd)
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+mkdir -p "$work/Flux_config" "$work/run"
+cat > "$work/Flux_config/Uniform_params.txt" <<CFG
+particles: proton
+fractions: 1.
+
+E_min: $energy
+E_max: $energy
+CFG
+sed "s|/run/beamOn .*|/run/beamOn $events|" "$here/mip_protons.mac" > "$work/run.mac"
+
+# 21^3 nodes over +-200 mm: x y z [mm] Bx By Bz [T]
+awk 'BEGIN { print "# x y z Bx By Bz"
+             for (k = 0; k < 21; k++) for (j = 0; j < 21; j++) for (i = 0; i < 21; i++)
+                 printf "%g %g %g 0 0.5 0\n", -200 + 20 * i, -200 + 20 * j, -200 + 20 * k }' > "$work/field.txt"
+
+cd "$work/run"
+run() { "$nadya" -i ../run.mac -noUI -t "$threads" -f Uniform -fd vertical_down --benchmark "$@" | grep "^Benchmark"; }
+
+run -o bench_off
+for accuracy in fast standard precise; do
+    run --field-uniform 0,0.5,0 --field-accuracy "$accuracy" -o "bench_uniform_$accuracy"
+    run --field-map ../field.txt --field-accuracy "$accuracy" -o "bench_map_$accuracy"
+done
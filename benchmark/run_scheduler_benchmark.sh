@@ -0,0 +1,32 @@
+#!/usr/bin/env bash
+# Scheduler benchmark: events/s with the MT (event-modulo requests) and tasking run managers over a
+# broad proton spectrum (10 keV - 1 TeV), where event cost varies by orders of magnitude.
+#   benchmark/run_scheduler_benchmark.sh <path/to/NADYA> [threads] [events] [modulos]
+set -euo pipefail
+
+nadya=$(realpath "$1")
+threads=${2:-$(nproc)}
+events=${3:-20000}
+modulos=${4:-0,1,10,100}
+here=$(cd "$(dirname "$0")" && pwd)
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+mkdir -p "$work/Flux_config" "$work/run"
+cat > "$work/Flux_config/Uniform_params.txt" <<CFG
+particles: proton
+fractions: 1.
+
+E_min: 0.01
+E_max: 1000000
+CFG
+sed "s|/run/beamOn .*|/run/beamOn $events|" "$here/mip_protons.mac" > "$work/run.mac"
+
+cd "$work/run"
+for manager in MT tasking; do
+    for modulo in ${modulos//,/ }; do
+        echo -n "event modulo $modulo: "
+        "$nadya" -i ../run.mac -noUI -t "$threads" -f Uniform -fd isotropic --benchmark \
+            --run-manager "$manager" --event-modulo "$modulo" -o "bench_${manager}_$modulo" | grep "^Benchmark"
+    done
+done
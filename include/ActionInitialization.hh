@@ -7,6 +7,7 @@
 #include "PrimaryGeneratorAction.hh"
 #include "EventAction.hh"
 #include "SteppingAction.hh"
+#include "StackingAction.hh"
 #include "Configuration.hh"
 #include "Geometry.hh"
 
@@ -19,6 +20,8 @@ public:
     void Build() const override;
 
 private:
+    void BuildEventActions(RunAction* runAct) const;
+
     G4double EminMeV;
     G4double EmaxMeV;
     G4double area;
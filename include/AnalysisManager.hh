@@ -5,10 +5,15 @@
 #include <G4AccumulableManager.hh>
 #include <G4Accumulable.hh>
 #include <G4UnitsTable.hh>
+#include <G4Threading.hh>
 #include <CLHEP/Units/SystemOfUnits.h>
 #include <globals.hh>
 #include <Sizes.hh>
 #include <Configuration.hh>
+#include <memory>
+
+#include "EventRecord.hh"
+#include "OutputQueue.hh"
 
 class AnalysisManager {
 public:
@@ -19,34 +24,46 @@ public:
     ~AnalysisManager() = default;
 
     void Open();
+    void SetFileName(const G4String& name) { fileName = name; }
     void Close();
 
-    void FillEventRow(G4int eventID, G4int nPrimaries, G4int nInteractions, G4int nEdepHits);
+    // Hands a finished event to the writer thread (--async-output) or writes it in place.
+    void Submit(EventRecord& rec);
+    // Synchronous path: fills this thread's G4AnalysisManager ntuples.
+    void WriteRecord(const EventRecord& rec);
+
+    void FillEventRow(G4int eventID, G4int nPrimaries, G4int nInteractions, G4int nEdepHits,
+                      G4double weight = 1.0);
 
     void FillPrimaryRow(G4int eventID, const G4String& primaryName,
                         G4double E_MeV, const G4ThreeVector& dir,
-                        const G4ThreeVector& pos_mm);
+                        const G4ThreeVector& pos_mm, G4int seed1, G4int seed2,
+                        G4double weight = 1.0);
 
     void FillInteractionRow(G4int eventID,
                             G4int trackID, G4int parentID,
                             const G4String& process,
                             const G4String& volumeName,
+                            G4int volumeID,
                             const G4ThreeVector& x_mm,
                             G4double t_ns,
                             G4int secIndex, const G4String& secName,
-                            G4double secE_MeV, const G4ThreeVector& secDir);
+                            G4double secE_MeV, const G4ThreeVector& secDir,
+                            G4double weight = 1.0);
 
-    void FillEdepRow(G4int eventID, const G4String& det_name, G4double edep_MeV);
+    void FillEdepRow(G4int eventID, const G4String& det_name, G4double edep_MeV,
+                         G4double weight = 1.0);
 
-    void FillSiPMEventRow(int eventID, int npeC, int npeV, int npeB);
-    void FillSiPMChannelRow(int eventID, const G4String& subdet, int ch, int npe);
+    void FillSiPMEventRow(int eventID, int npeC, int npeV, int npeB, G4double weight = 1.0);
+    void FillSiPMChannelRow(int eventID, const G4String& subdet, int ch, int npe, G4double weight = 1.0);
 
     void FillPhotonCountRow(G4int eventID,
                             G4int npeCrystal, G4int npeVeto,
-                            G4int npeBottomVeto);
+                            G4int npeBottomVeto, G4double weight = 1.0);
 
     void FillPhotonRow(G4int eventID, G4int photonID, const G4String& det_name, G4int det_ch,
-                       G4double energy_eV, G4double x_mm, G4double y_mm, G4double z_mm);
+                       G4double energy_eV, G4double x_mm, G4double y_mm, G4double z_mm,
+                       G4double weight = 1.0);
 
     void FillGenEnergyHist(G4double E_MeV, G4double weight = 1.0);
     void FillTrigEnergyHist(G4double E_MeV, G4double weight = 1.0);
@@ -58,7 +75,16 @@ public:
                          G4int module,
                          G4int layer,
                          G4int fiberIndex,
-                         G4double edep_MeV);
+                         G4double edep_MeV,
+                         G4double weight = 1.0);
+
+    // Per-crystal energy deposition (calorimeter)
+    void FillCrystalHitRow(G4int eventID,
+                           G4int ix,
+                           G4int iy,
+                           G4int channel,
+                           G4double edep_MeV,
+                           G4double weight = 1.0);
 
     void FillEffAreaHist(G4double E_MeV, G4double value);
     void FillEffAreaOptHist(G4double E_MeV, G4double value);
@@ -67,6 +93,10 @@ public:
     void FillSensitivityOptHist(G4double E_MeV, G4double value);
 
 private:
+    // The owning thread's instance; only that thread touches it, the writer thread has its own NtupleWriter.
+    G4AnalysisManager* manager{};
+    std::unique_ptr<OutputQueue> queue;
+
     G4int eventNT{-1};
     G4int primaryNT{-1};
     G4int interactionsNT{-1};
@@ -75,6 +105,7 @@ private:
     G4int edepNT{-1};
 
     G4int fiberHitsNT{-1};
+    G4int crystalHitsNT{-1};
 
     G4int SiPMEventNT{-1};
     G4int SiPMChannelNT{-1};
@@ -94,6 +125,8 @@ private:
     G4double xMax{1000 * MeV};
 
     void Book();
+    void BookNtuples();
+    void BookHists();
 };
 
 
@@ -0,0 +1,61 @@
+#ifndef BOOTSTRAP_HH
+#define BOOTSTRAP_HH
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Poisson bootstrap over per-event outcomes: replica r gives event e the multiplicity k ~ Poisson(1),
+// drawn from a counter-based generator keyed by (seed, e, r), so results do not depend on the thread count.
+class Bootstrap {
+public:
+    struct Sample {
+        int nBins = 0;
+        std::vector<int> bin;             // energy bin of the event, [0, nBins)
+        std::vector<double> weight;       // storage weight (prescale)
+        std::vector<std::uint8_t> pass;   // trigger outcome
+    };
+
+    // Resampled per-bin sums, laid out [bin * replicas + r].
+    struct Replicas {
+        int nBins = 0;
+        int replicas = 0;
+        std::vector<double> total;
+        std::vector<double> passed;
+    };
+
+    struct Band {
+        double mean = 0.0;
+        double std = 0.0;
+        double p025 = 0.0;
+        double p16 = 0.0;
+        double p50 = 0.0;
+        double p84 = 0.0;
+        double p975 = 0.0;
+    };
+
+    Bootstrap(int replicas, std::uint64_t seed, unsigned threads = 0);
+
+    [[nodiscard]] Replicas Resample(const Sample& sample) const;
+
+    // Streaming form of Resample: zeroed sums, then one call per block of events. Event i of the block is
+    // resampled as event firstEvent + i, so feeding the blocks in order reproduces Resample exactly.
+    [[nodiscard]] Replicas Empty(int nBins) const;
+    void Accumulate(const Sample& sample, std::uint64_t firstEvent, Replicas& out) const;
+
+    static Band Summarize(std::vector<double> values);
+
+    static std::uint64_t Mix64(std::uint64_t x);
+
+private:
+    int replicas;
+    std::uint64_t seed;
+    unsigned threads;
+
+    [[nodiscard]] int Poisson1(std::uint64_t event, std::uint64_t replica) const;
+};
+
+#endif //BOOTSTRAP_HH
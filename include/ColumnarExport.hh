@@ -0,0 +1,40 @@
+#ifndef COLUMNAREXPORT_HH
+#define COLUMNAREXPORT_HH
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "TreeColumns.hh"
+
+// Chunked columnar dump of a tree (".ncol"), laid out so a reader can mmap it and view columns in place.
+//
+// [0,64)    header: "NADYACOL", u32 version, u32 alignment, u64 metaOffset, u64 metaBytes, zero padding
+// [64,...)  chunks: one buffer per column, each starting on a 64-byte boundary, native byte order
+// meta      JSON at metaOffset: tree, entries, byte_order, columns (name/type/width[/dictionary]),
+//           chunks (rows, [offset, bytes] per column)
+//
+// String columns are dictionary encoded: the buffer holds u32 codes into the column's dictionary.
+class ColumnarExport {
+public:
+    static constexpr std::uint32_t kVersion = 1;
+    static constexpr std::uint32_t kAlignment = 64;
+
+    static void Write(TTree* tree, const std::string& path, Long64_t chunkRows = 65536);
+
+private:
+    struct ColumnChunk {
+        std::vector<char> data;
+        std::unordered_map<std::string, std::uint32_t> codes;
+        std::vector<std::string> dictionary;
+    };
+
+    static void Pad(std::ofstream& out, std::uint64_t& offset);
+    static std::string JsonString(const std::string& s);
+};
+
+#endif //COLUMNAREXPORT_HH
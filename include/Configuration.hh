@@ -5,6 +5,9 @@
 #include <G4Types.hh>
 #include <G4SystemOfUnits.hh>
 
+#include <utility>
+#include <vector>
+
 
 namespace Configuration
 {
@@ -30,6 +33,54 @@ namespace Configuration
     inline G4String outputFile{"GammaCube.root"};
     inline G4bool saveSecondaries{false};
     inline G4bool savePhotons{false};
+    inline G4bool mergeNtuples{true};
+
+    inline G4bool asyncOutput{false};
+    inline G4int outputQueueDepth{256};
+    inline G4String outputBackpressure{"yield"};
+
+    inline G4String storeTrigger{"all"};
+    inline G4int storePrescale{1};
+
+    inline G4String exportFormat{"csv"};   // csv | binary | both
+
+    inline G4int bootstrapReplicas{0};
+    inline G4long bootstrapSeed{1};
+
+    inline G4String fiberPlacement{"parameterised"};   // parameterised | placement
+    inline G4bool benchmark{false};
+
+    // Job splitting: job jobIndex of jobCount runs its own stream derived from seed (-1 = random).
+    inline G4long seed{-1};
+    inline G4int jobIndex{0};
+    inline G4int jobCount{1};
+    // --replay-events: event i of the replay run re-simulates (runID, eventID) = replayEvents[i]
+    inline std::vector<std::pair<G4int, G4int>> replayEvents;
+
+    inline G4String runManagerType{"MT"};   // serial | MT | tasking | subevent
+    inline G4int eventModulo{0};   // events per worker request (MT) or task (tasking), 0 = Geant4 default
+    inline G4int subEventSize{10000};   // optical photons per sub-event (subevent run manager)
+
+    inline G4bool checkOverlaps{false};
+    inline G4String overlapCacheDir{"../.overlap_cache"};
+
+    inline G4String emPhysics{"opt4"};  // opt4 | regional (opt4 in Calorimeter and Fibers, opt0 elsewhere)
+    inline G4String cutsConfig{};   // per-region production cuts, empty = physics list default everywhere
+    inline G4String physicsCacheDir{};   // stored physics tables, empty = build every run
+
+    // Magnetic field: uniform (Bx, By, Bz) or a field map file; neither = no field.
+    inline std::vector<G4double> fieldUniform;
+    inline G4String fieldMap{};
+    inline G4String fieldAccuracy{"standard"};   // fast | standard | precise
+    inline std::vector<G4String> fieldRegions{"World"};   // World or region names (see Geometry::DefineRegions)
+
+    // Threshold scan grids; a missing grid falls back to the single threshold above.
+    inline G4bool thresholdScan{false};
+    inline std::vector<G4double> scanCrystalThresholds;
+    inline std::vector<G4double> scanVetoThresholds;
+    inline std::vector<G4int> scanOptCrystalThresholds;
+    inline std::vector<G4int> scanOptVetoThresholds;
+    inline std::vector<G4int> scanOptBottomThresholds;
 }
 
 
@@ -3,7 +3,6 @@
 
 #include <vector>
 #include <string>
-#include <functional>
 #include <stdexcept>
 #include <cmath>
 #include <fstream>
@@ -11,61 +10,26 @@
 #include <limits>
 #include <algorithm>
 
-enum class FluxType { PLAW, COMP, SEP, UNIFORM, GALACTIC, TABLE };
-
-struct EnergyRange {
-    double Emin;
-    double Emax;
-};
-
-struct FluxParams {
-    // PLAW / COMP
-    double A = 0.0;
-    double alpha = 0.0;
-    double E_piv = 1.0;
-    double E_peak = 1.0; // only COMP
-
-    // SEP
-    int sep_year = 0;
-    int sep_order = 0;
-    std::string sep_csv_path; // path to CSV with coefficients
-
-    // Galactic
-    double phiMV = 600.0;
-    std::string particle = "proton";
-
-    // Table
-    std::string table_path;
-};
+#include "Quadrature.hh"
+#include "Spectrum.hh"
 
+// Counts may be weighted sums when they come from prescaled ntuples (see --prescale).
 struct RateCounts {
-    int crystalOnly = 0;    // N_det (Crystal && !Veto)
-    int crystalAndVeto = 0; // N_det (Crystal && Veto)
+    double crystalOnly = 0.0;    // N_det (Crystal && !Veto)
+    double crystalAndVeto = 0.0; // N_det (Crystal && Veto)
 };
 
 struct RateResult {
     double area = 0.0;
     double integral = 0.0;        // ∫ flux(E) dE
+    double integralErr = 0.0;     // quadrature error estimate of integral
     double Ndot = 0.0;            // A_eff * integral
     double rateCrystal = 0.0;     // crystalOnly / (N / Ndot)
     double rateBoth = 0.0;        // (crystalOnly+crystalAndVeto) / (N / Ndot)
     double rateRealCrystal = 0.0; // ∫ flux(E) * Aeff(E) dE
+    double rateRealErr = 0.0;     // quadrature error estimate of rateRealCrystal
 };
 
-double fluxPLAW(double E, double A, double alpha, double E_piv);
-
-double fluxCOMP(double E, double A, double alpha, double E_piv, double E_peak);
-
-double fluxSEP(double E, int year, int order, const std::string& csvPath);
-
-double fluxTable(double E, const std::string& csvPath);
-
-double fluxUniform(double E);
-
-double fluxGalactic(double E);
-
-double J_proton(double E_GeV);
-
 enum class FluxDir { Vertical_down, Vertical_up, Horizontal, Isotropic_up, Isotropic_down, Isotropic };
 
 /** Area in cm^2 for a rectangular envelope: halfX_mm, halfY_mm (half extents), sizeZ_mm (full height). */
@@ -77,18 +41,19 @@ double AreaRect_cm2(double halfX_mm, double halfY_mm, double sizeZ_mm, FluxDir d
 double AreaGen_cm2(double halfY_mm, double sizeZ_mm, double radiusVerticalDown_mm, double radiusSphere_mm, FluxDir dir);
 
 
-double integrateAdaptiveSimpson(const std::function<double(double)>& f,
-                                double a, double b,
-                                double rel_tol = 1e-6, int max_depth = 20);
-
-
 RateResult computeRate(FluxType type,
                        const FluxParams& p,
                        EnergyRange eRange,
                        double A_eff_cm2,
-                       int N_histories,
+                       long long N_histories,
                        const RateCounts& detCounts);
 
+/** ∫ flux dE over each log bin (with the Galactic GeV / m^2 scaling), so that Rate_Real = sum_i w_i * Aeff_i. */
+std::vector<double> foldingWeights(FluxType type,
+                                   const FluxParams& p,
+                                   EnergyRange eRange,
+                                   int nBins);
+
 RateResult computeRateReal(FluxType type,
                            const FluxParams& p,
                            EnergyRange eRange,
@@ -0,0 +1,27 @@
+#ifndef CRYSTALPARAMETERISATION_HH
+#define CRYSTALPARAMETERISATION_HH
+
+#include <G4VPVParameterisation.hh>
+#include <G4VPhysicalVolume.hh>
+#include <G4ThreeVector.hh>
+
+// Calorimeter crystal grid centred on the container: copyNo = iy * rowsX + ix.
+class CrystalParameterisation : public G4VPVParameterisation {
+public:
+    CrystalParameterisation(G4int rowsX, G4int rowsY, G4double pitchX, G4double pitchY);
+    ~CrystalParameterisation() override = default;
+
+    void ComputeTransformation(G4int copyNo, G4VPhysicalVolume* pv) const override;
+
+    [[nodiscard]] G4int GetCopies() const { return rowsX * rowsY; }
+
+    [[nodiscard]] static G4int Channel(const G4int ix, const G4int iy, const G4int rowsX) { return iy * rowsX + ix; }
+
+private:
+    G4int rowsX;
+    G4int rowsY;
+    G4double pitchX;  // crystal width + gap
+    G4double pitchY;
+};
+
+#endif //CRYSTALPARAMETERISATION_HH
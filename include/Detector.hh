@@ -7,6 +7,7 @@
 #include <G4SystemOfUnits.hh>
 #include <G4NistManager.hh>
 #include <G4PVPlacement.hh>
+#include <G4PVParameterised.hh>
 #include <G4MaterialPropertiesTable.hh>
 #include <G4Element.hh>
 #include <G4Box.hh>
@@ -16,6 +17,9 @@
 #include <algorithm>
 
 #include "Sizes.hh"
+#include "Configuration.hh"
+#include "FiberParameterisation.hh"
+#include "CrystalParameterisation.hh"
 
 class Detector {
 public:
@@ -45,10 +49,19 @@ public:
     [[nodiscard]] G4LogicalVolume* GetPostCaloACLV() const { return postCaloACLV; }
     [[nodiscard]] G4LogicalVolume* GetCoordDetectorLV() const { return coordDetectorLV; }
     [[nodiscard]] G4LogicalVolume* GetFiberStripLV() const { return fiberCoreLV; }
+    [[nodiscard]] G4LogicalVolume* GetCrystalLV() const { return crystalLV; }
+
+    // Containers, used as region roots
+    [[nodiscard]] G4LogicalVolume* GetInstrumentLV() const { return cubeOuterLV; }
+    [[nodiscard]] G4LogicalVolume* GetFiberModuleLV() const { return moduleLV; }
+    [[nodiscard]] G4LogicalVolume* GetCalorimeterArrayLV() const { return calorimeterArrayLV; }
 
 private:
     G4LogicalVolume* worldLV;
 
+    // Placements are not checked one by one; OverlapCheck validates the finished tree on request.
+    static constexpr G4bool checkOverlaps = false;
+
     // Materials
     G4Material* airMat{};
     G4Material* tofMat{};
@@ -66,9 +79,12 @@ private:
     G4LogicalVolume* postCaloACLV{};
     G4LogicalVolume* coordDetectorLV{};
     G4LogicalVolume* fiberCoreLV{};
+    G4LogicalVolume* crystalLV{};
 
     // Containers
     G4LogicalVolume* cubeOuterLV{};
+    G4LogicalVolume* moduleLV{};
+    G4LogicalVolume* calorimeterArrayLV{};
 
     // Build steps
     void ConstructShellAndContainers();
@@ -9,8 +9,13 @@
 #include <G4RunManager.hh>
 #include <G4SDManager.hh>
 #include <G4HCofThisEvent.hh>
+#include <G4VUserEventInformation.hh>
 #include <G4SystemOfUnits.hh>
+#include <G4AutoLock.hh>
+#include <Randomize.hh>
 #include <cfloat>
+#include <map>
+#include <unordered_map>
 #include <vector>
 
 #include "Geometry.hh"
@@ -18,15 +23,20 @@
 #include "Sizes.hh"
 #include "Configuration.hh"
 #include "AnalysisManager.hh"
+#include "EventRecord.hh"
 #include "SDHit.hh"
 #include "SiPMOpticalSD.hh"
 
 class G4Event;
 class Geometry;
 
+// Which events are always stored; each other event is kept with probability 1/storePrescale and weight storePrescale.
+enum class StoreTrigger { All, TOF, Crystal, CrystalOnly, CrystalOpt };
+
 struct PrimaryRec {
     int index = 0;
     int pdg = 0;
+    long seeds[2]{};       // Ranecu seeds the event started from
     G4String name;
     double E_MeV = 0.0;
     G4ThreeVector dir;
@@ -58,6 +68,33 @@ struct PhotonRec {
     G4ThreeVector pos_mm;  // mm
 };
 
+// SiPM counts (and detected photons with --save-photons) of an optical photon sub-event, carried back
+// to the parent event by the subevent run manager; EventAction keeps the sum of each parent's sub-events.
+class SiPMSubEventInfo : public G4VUserEventInformation {
+public:
+    void Print() const override {}
+
+    void Add(const SiPMSubEventInfo& sub) {
+        npeCrystal += sub.npeCrystal;
+        npeVeto += sub.npeVeto;
+        npeBottom += sub.npeBottom;
+        for (const auto& kv : sub.perChCrystal) perChCrystal[kv.first] += kv.second;
+        for (const auto& kv : sub.perChVeto) perChVeto[kv.first] += kv.second;
+        for (const auto& kv : sub.perChBottom) perChBottom[kv.first] += kv.second;
+        photons.insert(photons.end(), sub.photons.begin(), sub.photons.end());
+    }
+
+    int npeCrystal{0};
+    int npeVeto{0};
+    int npeBottom{0};
+
+    std::unordered_map<int,int> perChCrystal;
+    std::unordered_map<int,int> perChVeto;
+    std::unordered_map<int,int> perChBottom;
+
+    std::vector<PhotonRec> photons;
+};
+
 class EventAction : public G4UserEventAction {
 public:
     std::vector<PrimaryRec> primBuf;
@@ -70,6 +107,11 @@ public:
 
     void BeginOfEventAction(const G4Event *) override;
     void EndOfEventAction(const G4Event *) override;
+#ifdef NADYA_SUBEVENT_PARALLEL
+    void MergeSubEvent(G4Event *masterEvent, const G4Event *subEvent) override;
+    // Master only, from RunAction::EndOfRunAction: writes the parent events held back during the run.
+    void FinishDeferredEvents();
+#endif
 
     // New trigger: event registered iff signal in all four TOF panels and no signal in AC (Veto/PostCaloAC).
     [[nodiscard]] bool HasTOFAndNoAC() const {
@@ -84,6 +126,12 @@ private:
     int WriteEdepFromSD_(const G4Event *evt, int eventID);
 
     void WriteSiPMFromSD_(int eventID);
+    void WriteSiPM_(int npeC, int npeV, int npeB, const std::unordered_map<int,int>& perChCrystal,
+                    const std::unordered_map<int,int>& perChVeto, const std::unordered_map<int,int>& perChBottom);
+    // Optical run counters, threshold scan and the store decision, taken once the SiPM counts are final.
+    void FinishEvent_(double primaryE_MeV, double draw);
+
+    [[nodiscard]] bool PassesStoreTrigger_() const;
 
     void MarkCrystal() { hasCrystal = true; }
     void MarkVeto() { hasVeto = true; }
@@ -92,6 +140,8 @@ private:
     void MarkVetoOpt() { hasVetoOpt = true; }
 
     AnalysisManager *analysisManager = nullptr;
+    EventRecord record;
+    StoreTrigger storeTrig = StoreTrigger::All;
 
     std::vector<std::tuple<G4String, int, G4String>> detMap;
     std::vector<std::tuple<G4String, int, G4String>> optMap;
@@ -113,6 +163,33 @@ private:
     bool hasTrigger1Upper = false;
     bool hasTrigger2Lower = false;
     bool hasTrigger2Upper = false;
+
+    // Unthresholded per-event maxima for the threshold scan.
+    ScanEvent scanEvent;
+
+#ifdef NADYA_SUBEVENT_PARALLEL
+    // Parent event whose sub-events may still be running. MergeSubEvent is not ordered against the parent's
+    // EndOfEventAction; the end of the run is the first point where every sub-event is known to be merged.
+    struct DeferredEvent {
+        EventRecord record;
+        bool hasCrystal = false;
+        bool hasVeto = false;
+        bool hasTrigger1Lower = false;
+        bool hasTrigger1Upper = false;
+        bool hasTrigger2Lower = false;
+        bool hasTrigger2Upper = false;
+        ScanEvent scanEvent;
+        double primaryE_MeV = -1.0;
+        double draw = 0.0;
+    };
+
+    void DeferEvent_(double primaryE_MeV, double draw);
+
+    // Keyed by event ID, so events are written in order. subEventSums is filled from the worker threads.
+    std::map<int, DeferredEvent> deferred;
+    std::map<int, SiPMSubEventInfo> subEventSums;
+    G4Mutex mergeMutex = G4MUTEX_INITIALIZER;
+#endif
 };
 
 #endif //EVENTACTION_HH
@@ -0,0 +1,107 @@
+#ifndef EVENTRECORD_HH
+#define EVENTRECORD_HH
+
+#include <G4Types.hh>
+#include <G4String.hh>
+#include <vector>
+
+// Completed event, flattened into plain rows so it can be handed to the output writer.
+// Vectors are recycled between events; names are kept whole so no particle or volume name is cut.
+
+struct PrimaryRow {
+    G4String name;
+    G4double E_MeV;
+    G4double dir[3];
+    G4double pos_mm[3];
+    G4int seeds[2];
+};
+
+struct InteractionRow {
+    G4int trackID;
+    G4int parentID;
+    G4String process;
+    G4String volumeName;
+    G4int volumeID;          // crystal channel or fiber index inside parameterised volumes
+    G4double pos_mm[3];
+    G4double t_ns;
+    G4int secIndex;
+    G4String secName;
+    G4double secE_MeV;
+    G4double secDir[3];
+};
+
+struct EdepRow {
+    G4String detName;
+    G4double edep_MeV;
+};
+
+struct FiberHitRow {
+    G4int plane;
+    G4int module;
+    G4int layer;
+    G4int fiberIndex;
+    G4double edep_MeV;
+};
+
+struct CrystalHitRow {
+    G4int ix;
+    G4int iy;
+    G4int channel;
+    G4double edep_MeV;
+};
+
+struct SiPMChannelRow {
+    G4String subdet;
+    G4int ch;
+    G4int npe;
+};
+
+struct PhotonRow {
+    G4int photonID;
+    G4String detName;
+    G4int detCh;
+    G4double energy_eV;
+    G4double pos_mm[3];
+};
+
+struct EventRecord {
+    G4int eventID = -1;
+    G4double weight = 1.0;   // prescale factor of the stored event
+
+    G4bool hasEventRow = false;
+    G4int nPrimaries = 0;
+    G4int nInteractions = 0;
+    G4int nEdepHits = 0;
+
+    G4bool hasSiPMEvent = false;
+    G4int npe[3]{};          // crystal, veto, bottom veto
+
+    G4bool hasPhotonCount = false;
+    G4int photonCount[3]{};  // crystal, veto, bottom veto
+
+    std::vector<PrimaryRow> primaries;
+    std::vector<InteractionRow> interactions;
+    std::vector<EdepRow> edeps;
+    std::vector<FiberHitRow> fiberHits;
+    std::vector<CrystalHitRow> crystalHits;
+    std::vector<SiPMChannelRow> sipmChannels;
+    std::vector<PhotonRow> photons;
+
+    void Clear() {
+        eventID = -1;
+        weight = 1.0;
+        hasEventRow = hasSiPMEvent = hasPhotonCount = false;
+        nPrimaries = nInteractions = nEdepHits = 0;
+        npe[0] = npe[1] = npe[2] = 0;
+        photonCount[0] = photonCount[1] = photonCount[2] = 0;
+        primaries.clear();
+        interactions.clear();
+        edeps.clear();
+        fiberHits.clear();
+        crystalHits.clear();
+        sipmChannels.clear();
+        photons.clear();
+    }
+};
+
+#endif //EVENTRECORD_HH
@@ -0,0 +1,33 @@
+#ifndef FIBERPARAMETERISATION_HH
+#define FIBERPARAMETERISATION_HH
+
+#include <G4VPVParameterisation.hh>
+#include <G4VPhysicalVolume.hh>
+#include <G4RotationMatrix.hh>
+#include <G4ThreeVector.hh>
+#include <geomdefs.hh>
+#include <vector>
+
+// One TOF fiber plane: copyNo = layer * rows + fiberIndex, the numbering SensitiveDetector decodes.
+// Fibers lie along the plane's other axis, so only the offset along `axis` and the layer z vary.
+class FiberParameterisation : public G4VPVParameterisation {
+public:
+    FiberParameterisation(EAxis axis, G4int rows, G4double step,
+                          std::vector<G4double> firstOffset, std::vector<G4double> layerZ,
+                          G4RotationMatrix* rotation);
+    ~FiberParameterisation() override = default;
+
+    void ComputeTransformation(G4int copyNo, G4VPhysicalVolume* pv) const override;
+
+    [[nodiscard]] G4int GetCopies() const { return rows * static_cast<G4int>(layerZ.size()); }
+
+private:
+    EAxis axis;
+    G4int rows;
+    G4double step;
+    std::vector<G4double> firstOffset;  // centre of fiber 0 in each layer
+    std::vector<G4double> layerZ;
+    G4RotationMatrix* rotation;
+};
+
+#endif //FIBERPARAMETERISATION_HH
@@ -0,0 +1,44 @@
+#ifndef FIELDMAP_HH
+#define FIELDMAP_HH
+
+#include <G4MagneticField.hh>
+#include <G4SystemOfUnits.hh>
+#include <G4Types.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Tabulated 3D magnetic field on a regular grid, trilinear interpolation, zero outside the grid.
+// File rows are "x y z Bx By Bz" in mm and tesla, in any order; '#' starts a comment.
+// The grid is read once on the master (Load) and shared read-only by every thread's FieldMap.
+class FieldMap : public G4MagneticField {
+public:
+    struct Grid {
+        G4int n[3]{};
+        G4double min[3]{};
+        G4double invStep[3]{};
+        std::vector<G4double> b;   // Bx, By, Bz per node, x fastest, then y, then z
+    };
+
+    FieldMap();
+    ~FieldMap() override = default;
+
+    void GetFieldValue(const G4double point[4], G4double* bField) const override;
+
+    static void Load(const std::string& path);
+
+private:
+    std::shared_ptr<const Grid> grid;
+
+    inline static std::shared_ptr<const Grid> shared;
+
+    static std::vector<G4double> Axis(std::vector<G4double> v, const std::string& name, const std::string& path);
+};
+
+#endif //FIELDMAP_HH
@@ -12,10 +12,9 @@ private:
     G4double alpha{};
     G4double E_Peak{};
 
-    std::vector<double> energyGrid;
-    std::vector<double> cdfGrid;
+    std::shared_ptr<const FluxTable> table;
 
-    void BuildCDF();
+    FluxTable BuildCDF();
 
     G4double SampleEnergy() override;
 };
@@ -8,6 +8,12 @@
 #include <Randomize.hh>
 #include <algorithm>
 #include <cmath>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
 #include <vector>
 #include <string>
 #include <numeric>
@@ -20,6 +26,12 @@ struct ParticleInfo {
     G4double energy;
 };
 
+// Sampling grid of a tabulated spectrum: energies and the normalised CDF at each of them.
+struct FluxTable {
+    std::vector<G4double> energy;
+    std::vector<G4double> cdf;
+};
+
 
 class Flux {
 public:
@@ -27,6 +39,9 @@ public:
 
     virtual ParticleInfo GenerateParticle();
 
+    // Drops the shared tables when the configuration changes; generators keep the tables they hold.
+    static void ClearTables();
+
 protected:
     G4String particle;
     G4String configFile;
@@ -44,9 +59,31 @@ protected:
                       const G4String &,
                       G4double);
 
+    // Tables are built once per key (flux type, spectrum parameters, energy range) and shared read-only
+    // by the generators of all threads; only the sampling RNG is per thread. Different keys build in parallel.
+    static std::shared_ptr<const FluxTable> SharedTable(const std::string &key,
+                                                        const std::function<FluxTable()> &build);
+
+    template <typename... Parts>
+    static std::string TableKey(const Parts &... parts) {
+        std::ostringstream out;
+        out << std::setprecision(17);
+        ((out << parts << ';'), ...);
+        return out.str();
+    }
+
 private:
     std::unordered_map<std::string, std::string> cache{};
 
+    // The registry lock is only held to find the slot; the first caller of a key builds it under call_once.
+    struct TableSlot {
+        std::once_flag built;
+        std::shared_ptr<const FluxTable> table;
+    };
+
+    inline static std::mutex tablesMutex;
+    inline static std::map<std::string, std::shared_ptr<TableSlot>> tables;
+
     void LoadFileIfNeeded(const G4String &);
 };
 
@@ -11,10 +11,9 @@ public:
 private:
     G4double phiMV{};
 
-    std::vector<G4double> energyGrid;
-    std::vector<G4double> cdfGrid;
+    std::shared_ptr<const FluxTable> table;
 
-    void BuildCDF();
+    FluxTable BuildCDF();
 
     [[nodiscard]] G4double J_Proton(G4double E) const;
     [[nodiscard]] G4double J_Electron(G4double E) const;
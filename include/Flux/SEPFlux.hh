@@ -21,10 +21,9 @@ private:
     G4int year{};
     G4int order{};
 
-    std::vector<G4double> EList;
-    std::vector<G4double> CDF;
+    std::shared_ptr<const FluxTable> table;
 
-    void BuildCDF();
+    FluxTable BuildCDF();
 
     G4double SampleEnergy() override;
 };
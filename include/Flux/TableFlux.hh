@@ -25,10 +25,9 @@ public:
 private:
     G4String path;
 
-    std::vector<G4double> EList;
-    std::vector<G4double> CDF;
+    std::shared_ptr<const FluxTable> table;
 
-    void BuildCDF();
+    FluxTable BuildCDF();
 
     G4double SampleEnergy() override;
 };
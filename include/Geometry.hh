@@ -10,12 +10,19 @@
 #include <G4SystemOfUnits.hh>
 #include <G4SDManager.hh>
 #include <G4LogicalVolumeStore.hh>
+#include <G4Region.hh>
+#include <G4RegionStore.hh>
+#include <G4ProductionCuts.hh>
+#include <G4ProductionCutsTable.hh>
 #include <algorithm>
 #include <string>
 
 #include "Detector.hh"
 #include "SensitiveDetector.hh"
 #include "Sizes.hh"
+#include "Configuration.hh"
+#include "OverlapCheck.hh"
+#include "MagneticField.hh"
 
 class Geometry : public G4VUserDetectorConstruction {
 public:
@@ -25,6 +32,8 @@ public:
     G4VPhysicalVolume* Construct() override;
     void ConstructSDandField() override;
 
+    [[nodiscard]] const std::string& GetGeometryHash() const { return geometryHash; }
+
 private:
     G4NistManager* nist{};
     G4Material* worldMat{};
@@ -33,6 +42,7 @@ private:
     G4VPhysicalVolume* worldPV{};
 
     Detector* detector{};
+    std::string geometryHash;
 
     // Sensitive LVs
     G4LogicalVolume* trigger1LowerLV{};
@@ -43,6 +53,11 @@ private:
     G4LogicalVolume* postCaloACLV{};
     G4LogicalVolume* coordDetectorLV{};
     G4LogicalVolume* fiberStripLV{};
+    G4LogicalVolume* crystalLV{};
+
+    void DefineRegions() const;
+    void AttachField() const;
+    static G4VSensitiveDetector* GetOrCreateSD(const G4String& name, G4int id, const G4String& detName);
 };
 
 #endif // GEOMETRY_HH
@@ -0,0 +1,36 @@
+#ifndef INFOFILE_HH
+#define INFOFILE_HH
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Reader for the info_*.txt files written by Loader::SaveConfig.
+// "Key: value" lines are stored as-is; lines inside a "Block:\n{ ... }" are stored as "Block.Key".
+class InfoFile {
+public:
+    explicit InfoFile(const std::string& path);
+
+    [[nodiscard]] const std::string& Path() const { return path; }
+
+    [[nodiscard]] bool Has(const std::string& key) const;
+    [[nodiscard]] const std::string& Get(const std::string& key) const;
+    [[nodiscard]] std::string GetOr(const std::string& key, const std::string& def) const;
+    [[nodiscard]] double GetDouble(const std::string& key) const;
+    [[nodiscard]] int GetInt(const std::string& key) const;
+    [[nodiscard]] bool GetBool(const std::string& key) const;
+
+    // Keys in file order, for rewriting the file.
+    [[nodiscard]] const std::vector<std::string>& Keys() const { return keys; }
+
+private:
+    std::string path;
+    std::unordered_map<std::string, std::string> values;
+    std::vector<std::string> keys;
+};
+
+#endif //INFOFILE_HH
@@ -0,0 +1,53 @@
+#ifndef JOBMERGE_HH
+#define JOBMERGE_HH
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <TFile.h>
+#include <TFileMerger.h>
+#include <TH1.h>
+
+#include "CountRates.hh"
+#include "InfoFile.hh"
+#include "PostProcessing.hh"
+
+// Combines the jobs of one run split with --job-index/--job-count: the ROOT files are merged, the
+// derived effective-area/sensitivity histograms and the rates are recomputed from the summed counts,
+// and the info file of the first job is rewritten into one describing the merged run.
+class JobMerge {
+public:
+    struct Input {
+        std::string infoPath;
+        PostProcessingSettings settings;
+    };
+
+    explicit JobMerge(std::vector<Input> inputs);
+
+    // Writes mergedInfo and the merged ROOT file next to it.
+    void Write(const std::string& mergedInfo) const;
+
+private:
+    std::vector<Input> inputs;
+    std::vector<InfoFile> infos;
+
+    [[nodiscard]] static std::string StripJobTag(const std::string& s);
+    static void SetInfoValue(std::string& text, const std::string& key, const std::string& value);
+    static void EraseInfoEntry(std::string& text, const std::string& key);
+
+    void MergeRoot(const std::string& outPath) const;
+    [[nodiscard]] std::vector<double> RebuildDerived(TFile& file, const std::string& trigName,
+                                                     const std::vector<std::string>& derivedNames) const;
+};
+
+#endif //JOBMERGE_HH
@@ -13,14 +13,20 @@
 #include <G4OpticalPhysics.hh>
 #include <G4OpticalParameters.hh>
 #include <G4StepLimiterPhysics.hh>
+#include <G4EmStandardPhysics.hh>
 #include <G4EmStandardPhysics_option4.hh>
+#include <G4EmParameters.hh>
 #include <G4Types.hh>
 #include <G4RadioactiveDecayPhysics.hh>
 #include <globals.hh>
 
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <optional>
+#include <random>
+#include <set>
 #include <sstream>
 
 #include <G4VisExecutive.hh>
@@ -32,11 +38,15 @@
 #include "ActionInitialization.hh"
 #include "CountRates.hh"
 #include "PostProcessing.hh"
+#include "PhysicsCache.hh"
 
+#include <G4RunManager.hh>
+#include <G4RunManagerFactory.hh>
 #ifdef G4MULTITHREADED
 #include <G4MTRunManager.hh>
-#else
-#include <G4RunManager.hh>
+#endif
+#ifdef NADYA_SUBEVENT_PARALLEL
+#include <G4SubEvtRunManager.hh>
 #endif
 
 
@@ -49,13 +59,10 @@ class Loader {
     std::vector<G4double> effArea;
     std::vector<G4double> effAreaOpt;
 
-#ifdef G4MULTITHREADED
-    G4MTRunManager *runManager;
-#else
     G4RunManager *runManager;
-#endif
 
     G4VisManager *visManager;
+    G4VModularPhysicsList *physicsList{};
 
 public:
     Loader(int argc, char **argv);
@@ -67,13 +74,38 @@ private:
     G4int crystalAndVeto{};
     G4int crystalOnlyOpt{};
     G4int crystalAndVetoOpt{};
+    G4long histories{};  // events processed by the last run: N of the info file and of its rates
 
     std::string geomConfigPath;
+    std::string geometryHash;
+    Geometry* realWorld{};
+
+    // --geom-sweep: geometry descriptions run one after another; sweepTag names the current one.
+    std::vector<G4String> geomSweep;
+    std::string sweepTag;
+
+    // --physics-cache: directory of the current physics revision, filled after the first run if empty.
+    std::string physicsCachePath;
+    bool storePhysicsTables{false};
 
     FluxDir dir{};
 
     [[nodiscard]] std::string ReadValue(const std::string &, const std::string &) const;
+    // Value of key in the flux config, nullopt when the file cannot be read or has no such key.
+    [[nodiscard]] std::optional<std::string> FindValue(const std::string &key) const;
+    // Throws std::runtime_error on a missing or malformed entry, so callers can treat the flux as optional.
+    void ReadFlux(FluxType &fType, FluxParams &fp, EnergyRange &er) const;
+    [[nodiscard]] std::string InfoFileName() const;
     void SaveConfig() const;
+    void SaveThresholdScan(const ThresholdScan &scan) const;
+    [[nodiscard]] PostProcessingSettings PostProcessingConfig() const;
+    [[nodiscard]] G4double GenerationArea() const;
+    void UsePhysicsCache();
+    void SeedEngine() const;
+    void CollectResults();
+    void RunGeometrySweep();
+    void ReplayEvents() const;
+    static std::string SweepTag(const std::string& path);
     void RunPostProcessing() const;
 };
 
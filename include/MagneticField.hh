@@ -3,6 +3,7 @@
 
 #include "G4SystemOfUnits.hh"
 #include "G4ThreeVector.hh"
+#include "G4MagneticField.hh"
 #include "G4UniformMagField.hh"
 #include "G4FieldManager.hh"
 #include "G4Mag_UsualEqRhs.hh"
@@ -10,18 +11,40 @@
 #include "G4MagIntegratorDriver.hh"
 #include "G4ChordFinder.hh"
 
+#include <sstream>
+
+#include "Configuration.hh"
+#include "FieldMap.hh"
+
+// Field, stepper and field manager of one thread. The field is uniform (--field-uniform) or
+// tabulated (--field-map); the accuracy preset trades propagation precision against speed.
 class MagneticField {
 public:
+    struct Preset {
+        const char* name;
+        G4bool lowOrderStepper;   // Bogacki-Shampine 2(3) instead of Dormand-Prince 4(5)
+        G4double minStep;
+        G4double deltaChord;
+        G4double deltaOneStep;
+        G4double deltaIntersection;
+        G4double epsilonMin;
+        G4double epsilonMax;
+    };
+
     MagneticField();
     ~MagneticField() = default;
 
     [[nodiscard]] G4FieldManager* GetFieldManager() const;
 
+    [[nodiscard]] static const Preset* FindPreset(const G4String& name);
+    [[nodiscard]] static G4bool Enabled();
+    [[nodiscard]] static G4String Describe();
+
     MagneticField(const MagneticField&) = delete;
     MagneticField& operator=(const MagneticField&) = delete;
 
 private:
-    G4UniformMagField* field = nullptr;
+    G4MagneticField* field = nullptr;
     G4Mag_UsualEqRhs* equation = nullptr;
     G4MagIntegratorStepper* stepper = nullptr;
     G4MagInt_Driver* driver = nullptr;
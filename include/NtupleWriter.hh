@@ -0,0 +1,66 @@
+#ifndef NTUPLEWRITER_HH
+#define NTUPLEWRITER_HH
+
+#include <memory>
+#include <string>
+
+#include <TFile.h>
+#include <TTree.h>
+#include <TBranch.h>
+
+#include "EventRecord.hh"
+
+// Ntuples of one worker under --async-output, owned by its OutputQueue and filled on the writer thread only.
+// G4AnalysisManager is thread-local and keeps the histograms; the trees and columns here are the ones
+// AnalysisManager::BookNtuples books in the synchronous mode, written to <stem>_w<thread>.root.
+class NtupleWriter {
+public:
+    explicit NtupleWriter(const std::string& path);
+    ~NtupleWriter();
+
+    NtupleWriter(const NtupleWriter&) = delete;
+    NtupleWriter& operator=(const NtupleWriter&) = delete;
+
+    void Write(const EventRecord& rec);
+    void Close();
+
+    static std::string PathFor(const std::string& rootPath, int thread);
+
+private:
+    std::unique_ptr<TFile> file;
+
+    TTree* edepNT{};
+    TTree* fiberHitsNT{};
+    TTree* crystalHitsNT{};
+    TTree* primaryNT{};
+    TTree* interactionsNT{};
+    TTree* eventNT{};
+    TTree* SiPMEventNT{};
+    TTree* SiPMChannelNT{};
+    TTree* photonsCountNT{};
+    TTree* photonsNT{};
+
+    // Column buffers shared by every tree that has the column.
+    Int_t eventID{};
+    Int_t job{};
+    Double_t weight{};
+    Int_t ints[5]{};
+    Double_t doubles[10]{};
+
+    // String columns are pointed at the row's G4String before each fill, so names are never cut.
+    TBranch* edepName{};
+    TBranch* primaryName{};
+    TBranch* processName{};
+    TBranch* volumeName{};
+    TBranch* secName{};
+    TBranch* subdetName{};
+    TBranch* photonDetName{};
+
+    TTree* NewTree(const char* name, const char* title);
+    static void AddI(TTree* tree, const char* column, Int_t* address);
+    static void AddD(TTree* tree, const char* column, Double_t* address);
+    static TBranch* AddS(TTree* tree, const char* column);
+    static void Point(TBranch* branch, const G4String& value);
+};
+
+#endif //NTUPLEWRITER_HH
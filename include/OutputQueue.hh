@@ -0,0 +1,51 @@
+#ifndef OUTPUTQUEUE_HH
+#define OUTPUTQUEUE_HH
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "EventRecord.hh"
+#include "NtupleWriter.hh"
+
+// Bounded single-producer/single-consumer ring between a worker's EventAction and its writer thread.
+// The ring is the only state the two threads share: the writer thread owns the NtupleWriter it fills, and the
+// worker's G4AnalysisManager is never touched from it.
+class OutputQueue {
+public:
+    enum class Backpressure { Yield, Sleep };
+
+    OutputQueue(std::size_t capacity, Backpressure policy);
+    ~OutputQueue();
+
+    OutputQueue(const OutputQueue&) = delete;
+    OutputQueue& operator=(const OutputQueue&) = delete;
+
+    // Creates <path>'s ntuples and hands them to a new writer thread.
+    void Start(const std::string& path);
+    // Drains everything pushed so far, closes the file and joins the writer.
+    void Stop();
+
+    // Moves the record into the ring (blocking while full); rec comes back cleared with recycled buffers.
+    void Push(EventRecord& rec);
+
+    [[nodiscard]] bool IsRunning() const { return writer.joinable(); }
+
+private:
+    void Drain();
+    void WaitOnFull() const;
+
+    std::unique_ptr<NtupleWriter> sink;
+    std::vector<EventRecord> slots;
+    Backpressure policy;
+
+    alignas(64) std::atomic<std::size_t> head{0};
+    alignas(64) std::atomic<std::size_t> tail{0};
+    std::atomic<bool> stopping{false};
+
+    std::thread writer;
+};
+
+#endif //OUTPUTQUEUE_HH
@@ -0,0 +1,39 @@
+#ifndef OVERLAPCHECK_HH
+#define OVERLAPCHECK_HH
+
+#include <G4VPhysicalVolume.hh>
+#include <G4LogicalVolume.hh>
+#include <G4VSolid.hh>
+#include <G4Material.hh>
+#include <G4VPVParameterisation.hh>
+#include <G4PhysicalVolumeStore.hh>
+#include <G4ios.hh>
+
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <string>
+
+#include "Utils.hh"
+
+// Overlap validation of a finished geometry tree, cached per geometry revision.
+// The revision is a hash of every logical volume (solid parameters, material, daughters) and
+// every placement (copy numbers and transforms, per copy for parameterised volumes).
+class OverlapCheck {
+public:
+    static std::string GeometryHash(G4VPhysicalVolume* world);
+
+    [[nodiscard]] static bool IsValidated(const std::string& hash, const std::string& cacheDir);
+
+    // Checks every placement below world unless cacheDir already records a pass for this hash.
+    // Returns true when the geometry is known to be free of overlaps.
+    static bool Run(G4VPhysicalVolume* world, const std::string& hash, const std::string& cacheDir,
+                    G4int resolution = 1000);
+
+private:
+    static void Describe(const G4LogicalVolume* lv, std::ostringstream& out, std::set<const G4LogicalVolume*>& seen);
+};
+
+#endif //OVERLAPCHECK_HH
@@ -0,0 +1,38 @@
+#ifndef PHYSICSCACHE_HH
+#define PHYSICSCACHE_HH
+
+#include <G4VUserPhysicsList.hh>
+#include <G4Material.hh>
+#include <G4Element.hh>
+#include <G4Region.hh>
+#include <G4RegionStore.hh>
+#include <G4ProductionCuts.hh>
+#include <G4Version.hh>
+#include <G4ios.hh>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "Utils.hh"
+
+// Stored physics tables (/run/particle/storePhysicsTable), one directory per physics revision.
+// The revision is a hash of the physics list configuration, the Geant4 version, every material
+// (density, state, composition) and every region with its production cuts.
+// Only the EM tables (and the production cuts) are covered. The optical processes do not persist
+// their tables through StorePhysicsTable, and the hadronic cross sections and models of FTFP_BERT
+// are not stored either; both are still built on every run, so the saving is limited to the EM part
+// of initialisation.
+class PhysicsCache {
+public:
+    static std::string Key(const std::string& physicsConfig);
+
+    [[nodiscard]] static std::string Directory(const std::string& cacheDir, const std::string& key);
+    [[nodiscard]] static bool IsComplete(const std::string& dir);
+
+    // Writes the tables built by the last run into dir; only the master thread may call this.
+    static bool Store(G4VUserPhysicsList* physicsList, const std::string& dir);
+};
+
+#endif //PHYSICSCACHE_HH
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <memory>
+#include <algorithm>
 #include <stdexcept>
 #include <fstream>
 #include <utility>
@@ -12,9 +13,21 @@
 #include <set>
 #include <sstream>
 #include <filesystem>
+#include <unordered_map>
+#include <vector>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <string_view>
 
 #include <TFile.h>
 #include <TTree.h>
+#include <TChain.h>
+#include <TTreeIndex.h>
 #include <TLeaf.h>
 #include <TLeafC.h>
 #include <TH1.h>
@@ -23,17 +36,46 @@
 #include <TROOT.h>
 #include <TError.h>
 
-#include "Configuration.hh"
+#include "ColumnarExport.hh"
+#include "Bootstrap.hh"
+#include "CountRates.hh"
 
 class TFile;
 class TH1;
 
+// Everything a post-processing run needs; filled from Configuration by Loader or from an info file by NADYAPost.
+struct PostProcessingSettings {
+    std::string outputFile;
+    std::string outputFolderName;
+    std::string particle;
+    double eMinMeV = 0.0;
+    double eMaxMeV = 0.0;
+    double eCrystalThresholdMeV = 0.0;
+    int nBins = 1000;
+    bool useOptics = false;
+    bool saveSecondaries = false;
+    bool savePhotons = false;
+    bool mergeNtuples = true;
+    bool asyncOutput = false;  // ntuples in the writer files <stem>_w<i>.root instead
+    int ntupleThreads = 0;  // workers that wrote <stem>_t<i>.root, i < ntupleThreads (0 = sequential run)
+    std::string exportFormat = "csv";
+    unsigned threads = 0;  // export threads, 0 = all cores
+
+    double areaCm2 = 0.0;  // generation surface
+    int bootstrapReplicas = 0;  // 0 disables the bootstrap bands
+    std::uint64_t bootstrapSeed = 1;
+    std::string infoFile;  // receives the Bootstrap block
+
+    bool hasFlux = false;  // flux model known: folded rate replicas are computed
+    FluxType fluxType = FluxType::UNIFORM;
+    FluxParams fluxParams;
+    EnergyRange fluxRange{0.0, 0.0};  // flux-config energy range the rates integrate over
+    long long histories = 0;          // N of the run, for the rates from the stored (weighted) events
+};
+
 class PostProcessing {
 public:
-    PostProcessing(std::string outputFolderName,
-                   double eMinMeV,
-                   double eMaxMeV,
-                   std::string particle);
+    explicit PostProcessing(PostProcessingSettings settings);
 
     ~PostProcessing();
 
@@ -41,31 +83,78 @@ public:
     void SaveEffArea();
     void SaveSensitivity();
 
-    void SaveTrigEdepCsv();
-    void SaveEdepCsv();
+    // trig_edep.csv, edep.csv and, with optics, optic/trig_opt.csv and the *_channel.csv files, written in one
+    // pass over the ntuples. Every row starts with "job,eventID"; eventID alone is not unique once jobs are merged.
+    void SaveEventCsvs();
 
-    void SaveOpticsCsv();
+    [[nodiscard]] const std::string& RunDir() const { return runDir; }
+    static std::string RunDirFor(const PostProcessingSettings& settings);
+    // <stem><tag>0.root ... <stem><tag>(nThreads-1).root next to rootPath; files of other runs are never picked up.
+    static std::vector<std::string> ThreadFiles(const std::string& rootPath, int nThreads, const char* tag = "_t");
+    // Files holding the ntuples apart from outputFile: per-thread or writer files, empty when they were merged.
+    static std::vector<std::string> NtupleFiles(const PostProcessingSettings& settings);
 
 private:
-    std::string outputFolderName;
-    double eMinMeV;
-    double eMaxMeV;
-    std::string particleName;
+    PostProcessingSettings settings;
 
     std::unique_ptr<TFile> rootFile;
 
+    // Per-event state shared by the trig/edep/optics writers, rebuilt for each event of the merge.
+    struct EventSummary {
+        enum : std::uint8_t { kPrimary = 1, kEdep = 2, kSiPM = 4 };
+        // Detectors above threshold, enough to rebuild the run trigger (four TOF panels, no anticoincidence).
+        enum : std::uint8_t { kT1Lower = 1, kT1Upper = 2, kT2Lower = 4, kT2Upper = 8, kAC = 16 };
+
+        double e0 = 0.0;
+        double weight = 1.0;
+        double crystal = 0.0;
+        double veto = 0.0;
+        double bottomVeto = 0.0;
+        Int_t npe[3]{};  // crystal, veto, bottom veto
+        std::uint8_t flags = 0;
+        std::uint8_t hits = 0;
+
+        [[nodiscard]] bool EdepTrigger() const { return crystal > 0.0 && veto == 0.0 && bottomVeto == 0.0; }
+        [[nodiscard]] bool TOFTrigger() const { return hits == (kT1Lower | kT1Upper | kT2Lower | kT2Upper); }
+    };
+
+    bool eventsStreamed = false;
+    Bootstrap::Replicas bootstrapSums;  // filled by SaveEventCsvs when the bootstrap is on
+    RateCounts storedCounts;            // prescale-weighted counts of the stored events
+
+    // Files holding the ntuples: the output file itself, or the per-thread files when merging is off.
+    std::vector<std::string> ntupleFiles;
+
     std::string postProcessingDir;
     std::string runDir;
     std::string effectiveAreaDir;
     std::string sensitivityDir;
     std::string csvDir;
+    std::string columnarDir;
     std::string histogramsDir;
 
     void OpenRootFile();
     void PrepareOutputDirs();
 
-    void ExportTreeToCsv(const std::string& treeName,
-                         const std::string& csvPath);
+    // Fresh chain owned by the caller, for readers running on their own thread.
+    std::unique_ptr<TChain> MakeChain(const std::string& treeName) const;
+    // Binds the optional per-row "weight" column (absent in files written without prescaling).
+    static void BindWeight(TTree* tree, double* weight);
+
+    // Stored_counts block of the info file: storedCounts and, with a flux model, the rates they give.
+    void SaveStoredCounts() const;
+
+    // Poisson-bootstrap bands of area * N_trig / N_gen per energy bin, written to <dir>/<name>_bootstrap.csv;
+    // with a flux model also the folded Rate_Real replicas (rate_bootstrap.csv and the info file).
+    void SaveBootstrap(const std::string& dir, const std::string& name);
+    void WriteInfoBlock(const std::string& blockName, const std::string& body) const;
+
+    // Writes the tree as CSV and/or columnar binary according to exportFormat. Thread-safe.
+    void ExportTree(const std::string& treeName, unsigned formatThreads) const;
+
+    static void ExportTreeToCsv(TTree* tree,
+                                const std::string& csvPath,
+                                unsigned formatThreads);
 
     TH1* GetHistOrThrow(const std::string& histName);
 
@@ -43,6 +43,7 @@ private:
     G4double radius;
     G4ThreeVector center;
     G4ThreeVector detectorHalfSize;
+    G4int sizesRevision{-1};
 
     G4String fluxDirection;
     ParticleInfo pInfo{};
@@ -52,6 +53,8 @@ private:
     G4double eCrystalThreshold;
 
     void GenerateOnSphere(G4ThreeVector &pos, G4ThreeVector &dir) const;
+    // Sizes the generation sphere from the current envelope (re-run after a geometry sweep step).
+    void UpdateSource();
 };
 
 #endif //PRMIARYGENERATIONACTION_HH
@@ -0,0 +1,43 @@
+#ifndef QUADRATURE_HH
+#define QUADRATURE_HH
+
+#include <array>
+#include <cmath>
+#include <queue>
+#include <stdexcept>
+#include <vector>
+
+#include "Spectrum.hh"
+
+struct QuadOptions {
+    double relTol = 1e-8;
+    double absTol = 0.0;
+    int maxIntervals = 4000;
+};
+
+struct QuadResult {
+    double value = 0.0;
+    double error = 0.0;    // sum of |K15 - G7| over the final intervals
+    int evaluations = 0;
+    bool converged = false;
+};
+
+/** ∫_a^b flux(E) dE in model units (a > 0), integrated in u = ln E by adaptive 7/15-point
+ *  Gauss-Kronrod. The interval with the largest error is bisected until the tolerance is met. */
+QuadResult integrateLogGK(const Spectrum& spectrum, double a, double b, const QuadOptions& opt = {});
+
+/** ∫ flux(E) Aeff(E) dE for every spectrum, with Aeff (cm^2) constant inside each bin of edges (MeV).
+ *  The Kronrod nodes of all bins are shared, so each spectrum is evaluated once over the whole grid;
+ *  only bins that miss the tolerance are refined on their own. */
+std::vector<QuadResult> foldSpectra(const std::vector<const Spectrum*>& spectra,
+                                    const std::vector<double>& edges,
+                                    const std::vector<double>& Aeff,
+                                    const QuadOptions& opt = {});
+
+/** Per-bin ∫ flux dE over edges (MeV), converted to MeV / cm^2 with the spectrum's scales. */
+std::vector<double> binIntegrals(const Spectrum& spectrum,
+                                 const std::vector<double>& edges,
+                                 const QuadOptions& opt = {},
+                                 double* error = nullptr);
+
+#endif //QUADRATURE_HH
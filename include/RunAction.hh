@@ -7,17 +7,24 @@
 #include <G4Accumulable.hh>
 #include <G4AccumulableManager.hh>
 #include <G4Run.hh>
+#include <G4RunManager.hh>
 #include <G4ios.hh>
 #include <G4UnitsTable.hh>
 #include <Randomize.hh>
 #include <G4AnalysisManager.hh>
 #include <G4Threading.hh>
+#include <G4Timer.hh>
 #include <iomanip>
+#include <memory>
 #include <sstream>
 
 #include "Sizes.hh"
 #include "Configuration.hh"
 #include "AnalysisManager.hh"
+#include "ThresholdScan.hh"
+#include "MagneticField.hh"
+
+class EventAction;
 
 struct ParticleCounts {
     G4int crystalOnly = 0;
@@ -44,12 +51,18 @@ public:
     void AddGenerated(double E_MeV);
     void AddTriggeredCrystalOnly(double E_MeV);
     void AddTriggeredCrystalOnlyOpt(double E_MeV);
+    void AddScanEvent(ScanEvent ev, double primaryE_MeV);
+    void CountStep() { ++stepCount; }
+    void SetArea(const double Agen_cm2) { area = Agen_cm2; }
+    // Subevent run manager: the master's EventAction, whose held-back events are written at the end of the run.
+    void SetEventAction(EventAction *ea) { eventAction = ea; }
 
     [[nodiscard]] const ParticleCounts& GetCounts() const { return totals; }
     [[nodiscard]] const ParticleCounts& GetOptCounts() const { return totalsOpt; }
 
     [[nodiscard]] const std::vector<double>& GetEffArea() const { return effArea; }
     [[nodiscard]] const std::vector<double>& GetEffAreaOpt() const { return effAreaOpt; }
+    [[nodiscard]] const ThresholdScan* GetThresholdScan() const { return scan.get(); }
 
 private:
     G4Accumulable<G4int> crystalOnly{0};   // Crystal && !Veto
@@ -58,6 +71,7 @@ private:
     G4Accumulable<G4int> crystalAndVetoOpt{0};
     ParticleCounts totals{};
     ParticleCounts totalsOpt{};
+    EventAction *eventAction{};
 
     double EminMeV{0.0};
     double EmaxMeV{0.0};
@@ -72,6 +86,12 @@ private:
     std::vector<G4Accumulable<G4double>> trigOptCounts;
     std::vector<G4double> effArea;
     std::vector<G4double> effAreaOpt;
+    std::unique_ptr<ThresholdScan> scan;
+
+    // --benchmark: steps are counted in a plain per-thread counter and merged once per run.
+    G4long stepCount{0};
+    G4Accumulable<G4double> steps{0.0};
+    G4Timer timer;
 
     [[nodiscard]] int FindBinLog(double E_MeV) const;
     [[nodiscard]] double BinCenterMeV(int i) const;
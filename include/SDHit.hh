@@ -33,6 +33,10 @@ public:
     // fiber index inside a layer (0 .. rowsX/rowsY-1), -1 if unknown/not fiber
     G4int fiberIndex = -1;
 
+    // Calorimeter crystal column/row (copyNo = crystalY * rowsX + crystalX), -1 if not a crystal hit
+    G4int crystalX = -1;
+    G4int crystalY = -1;
+
     G4double x_loc_mm = 0.0;
     G4double y_loc_mm = 0.0;
     G4double z_loc_mm = 0.0;
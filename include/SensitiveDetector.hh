@@ -35,6 +35,10 @@ public:
     G4int GetDetID() const { return detID; }
     const G4String &GetDetName() const { return detName; }
 
+    // Channel of the touched volume: the replica number for parameterised crystals and fiber cores, the copy
+    // number otherwise. GetCopyNo() of a parameterised volume is that of its single placement.
+    static G4int VolumeID(const G4VTouchable *touch);
+
 private:
     SDHit *FindOrCreateHit(G4int volumeID);
 
@@ -12,6 +12,8 @@
 #include <G4VProcess.hh>
 #include <G4ProcessManager.hh>
 #include <G4VPhysicalVolume.hh>
+#include <G4EventManager.hh>
+#include <G4Threading.hh>
 
 #include "EventAction.hh"
 #include "AnalysisManager.hh"
@@ -26,6 +28,12 @@ public:
 
     void Initialize(G4HCofThisEvent*) override;
     G4bool ProcessHits(G4Step* step, G4TouchableHistory*) override;
+    void EndOfEvent(G4HCofThisEvent*) override;
+
+    // Workers of the subevent run manager only ever process optical photon sub-events.
+    static bool InSubEvent() {
+        return Configuration::runManagerType == "subevent" && G4Threading::IsWorkerThread();
+    }
 
     // getters for EventAction
     int GetNpeCrystal() const { return npeCrystal; }
@@ -0,0 +1,139 @@
+#ifndef SPECTRUM_HH
+#define SPECTRUM_HH
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+enum class FluxType { PLAW, COMP, SEP, UNIFORM, GALACTIC, TABLE };
+
+struct EnergyRange {
+    double Emin;
+    double Emax;
+};
+
+struct FluxParams {
+    // PLAW / COMP
+    double A = 0.0;
+    double alpha = 0.0;
+    double E_piv = 1.0;
+    double E_peak = 1.0; // only COMP
+
+    // SEP
+    int sep_year = 0;
+    int sep_order = 0;
+    std::string sep_csv_path; // path to CSV with coefficients
+
+    // Galactic
+    double phiMV = 600.0;
+    std::string particle = "proton";
+
+    // Table
+    std::string table_path;
+};
+
+// Flux models used by the rate calculations. A spectrum is immutable once built
+// (tables and coefficients are read in the constructor), so it can be shared between threads.
+class Spectrum {
+public:
+    virtual ~Spectrum() = default;
+
+    // out[i] = flux(E[i]) for energies in model units (see EnergyScale).
+    virtual void Evaluate(const double* E, double* out, std::size_t n) const = 0;
+
+    [[nodiscard]] double Evaluate(double E) const;
+    [[nodiscard]] std::vector<double> Evaluate(const std::vector<double>& E) const;
+
+    // Model energy unit per MeV and model area unit per cm^2 (GeV and m^2 for Galactic).
+    [[nodiscard]] double EnergyScale() const { return energyScale; }
+    [[nodiscard]] double AreaScale() const { return areaScale; }
+
+protected:
+    double energyScale = 1.0;
+    double areaScale = 1.0;
+};
+
+class PowerLawSpectrum final : public Spectrum {
+public:
+    PowerLawSpectrum(double A, double alpha, double E_piv);
+    void Evaluate(const double* E, double* out, std::size_t n) const override;
+    using Spectrum::Evaluate;
+
+private:
+    double A, alpha, invEpiv;
+};
+
+class CompSpectrum final : public Spectrum {
+public:
+    CompSpectrum(double A, double alpha, double E_piv, double E_peak);
+    void Evaluate(const double* E, double* out, std::size_t n) const override;
+    using Spectrum::Evaluate;
+
+private:
+    double A, alpha, invEpiv, cutoff;  // cutoff = (alpha - 2) / E_peak
+};
+
+// log10(flux) is a polynomial in log10(E); coefficients for (year, order) come from the SEP CSV.
+class SEPSpectrum final : public Spectrum {
+public:
+    SEPSpectrum(int year, int order, const std::string& csvPath);
+    void Evaluate(const double* E, double* out, std::size_t n) const override;
+    using Spectrum::Evaluate;
+
+private:
+    std::vector<double> coeffs;  // constant term first
+};
+
+// Two-column CSV (E, flux). Sorted on load; log-log interpolation between nodes with positive flux.
+class TableSpectrum final : public Spectrum {
+public:
+    explicit TableSpectrum(const std::string& csvPath);
+    void Evaluate(const double* E, double* out, std::size_t n) const override;
+    using Spectrum::Evaluate;
+
+private:
+    std::vector<double> energies;
+    std::vector<double> fluxes;
+    std::vector<double> logE;
+    std::vector<double> logF;  // NaN where flux <= 0
+
+    [[nodiscard]] double At(double E) const;
+};
+
+class UniformSpectrum final : public Spectrum {
+public:
+    UniformSpectrum(double E_min, double E_max);
+    void Evaluate(const double* E, double* out, std::size_t n) const override;
+    using Spectrum::Evaluate;
+
+private:
+    double invLogRange;
+};
+
+// Force-field modulated local interstellar spectra; energies in GeV, flux per m^2.
+class GalacticSpectrum final : public Spectrum {
+public:
+    enum class Particle { Proton, Electron, Positron, Alpha, Unknown };
+
+    GalacticSpectrum(double phiMV, const std::string& particle);
+    void Evaluate(const double* E, double* out, std::size_t n) const override;
+    using Spectrum::Evaluate;
+
+private:
+    Particle particle;
+    double mass = 0.0;
+    double phiGV;
+
+    [[nodiscard]] double LIS(double E) const;
+};
+
+std::unique_ptr<Spectrum> MakeSpectrum(FluxType type, const FluxParams& p, const EnergyRange& eRange);
+
+#endif //SPECTRUM_HH
@@ -0,0 +1,17 @@
+#ifndef STACKINGACTION_HH
+#define STACKINGACTION_HH
+
+#ifdef NADYA_SUBEVENT_PARALLEL
+#include <G4UserStackingAction.hh>
+#include <G4Track.hh>
+#include <G4OpticalPhoton.hh>
+
+// Master-thread stacking of the subevent run manager: optical photons produced in the parent event
+// are bundled into sub-events of type 0 (Configuration::subEventSize photons each) for idle workers.
+class StackingAction : public G4UserStackingAction {
+public:
+    G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track* track) override;
+};
+#endif
+
+#endif //STACKINGACTION_HH
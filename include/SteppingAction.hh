@@ -12,12 +12,16 @@
 #include <G4UserSteppingAction.hh>
 
 #include "EventAction.hh"
+#include "RunAction.hh"
 
 
 class SteppingAction : public G4UserSteppingAction {
 public:
-    SteppingAction() = default;
+    explicit SteppingAction(RunAction* run = nullptr) : run(run) {}
     void UserSteppingAction(const G4Step* step) override;
+
+private:
+    RunAction* run = nullptr;
 };
 
 #endif //STEPPINGACTION_HH
@@ -0,0 +1,82 @@
+#ifndef THRESHOLDSCAN_HH
+#define THRESHOLDSCAN_HH
+
+#include <G4Accumulable.hh>
+#include <G4AccumulableManager.hh>
+#include <globals.hh>
+
+#include <algorithm>
+#include <vector>
+
+// Threshold-independent summary of one event: the largest single-hit deposits and the npe sums
+// that EventAction compares against its thresholds.
+struct ScanEvent {
+    double crystalEdepMax = 0.0;  // MeV
+    double vetoEdepMax = 0.0;     // MeV, Veto and PostCaloAC
+    bool tof = false;             // all four TOF panels fired
+    int energyBin = -1;           // generation bin of the primary, -1 outside the range
+
+    bool hasOptics = false;
+    int npeCrystal = 0;
+    int npeVeto = 0;
+    int npeBottom = 0;
+};
+
+/* Counts and effective areas for a grid of thresholds in one run.
+ * Each event is reduced to the number of grid thresholds it passes per detector and histogrammed
+ * in that index space; the counts for every grid point are cumulative sums of these histograms,
+ * taken once on the master after the worker accumulables are merged. */
+class ThresholdScan {
+public:
+    ThresholdScan(std::vector<G4double> crystalMeV, std::vector<G4double> vetoMeV,
+                  std::vector<G4int> optCrystal, std::vector<G4int> optVeto, std::vector<G4int> optBottom,
+                  G4int nBins, G4bool useOptics);
+
+    void Register(G4AccumulableManager* mgr);
+    void Fill(const ScanEvent& ev);
+    void Finalize(const std::vector<G4double>& genCounts, G4double area);
+
+    [[nodiscard]] const std::vector<G4double>& CrystalGrid() const { return crystalGrid; }
+    [[nodiscard]] const std::vector<G4double>& VetoGrid() const { return vetoGrid; }
+    [[nodiscard]] const std::vector<G4int>& OptCrystalGrid() const { return optCrystalGrid; }
+    [[nodiscard]] const std::vector<G4int>& OptVetoGrid() const { return optVetoGrid; }
+    [[nodiscard]] const std::vector<G4int>& OptBottomGrid() const { return optBottomGrid; }
+    [[nodiscard]] G4bool HasOptics() const { return useOptics; }
+    [[nodiscard]] G4int Bins() const { return nBins; }
+
+    // [ic * nVeto + iv]
+    [[nodiscard]] const std::vector<G4double>& CrystalOnly() const { return crystalOnly; }
+    [[nodiscard]] const std::vector<G4double>& CrystalAndVeto() const { return crystalAndVeto; }
+    // [iv * nBins + bin]
+    [[nodiscard]] const std::vector<G4double>& EffArea() const { return effArea; }
+    // [(ic * nOptVeto + iv) * nOptBottom + ib]
+    [[nodiscard]] const std::vector<G4double>& CrystalOnlyOpt() const { return crystalOnlyOpt; }
+    [[nodiscard]] const std::vector<G4double>& CrystalAndVetoOpt() const { return crystalAndVetoOpt; }
+
+private:
+    std::vector<G4double> crystalGrid;
+    std::vector<G4double> vetoGrid;
+    std::vector<G4int> optCrystalGrid;
+    std::vector<G4int> optVetoGrid;
+    std::vector<G4int> optBottomGrid;
+    G4int nBins;
+    G4bool useOptics;
+
+    // Histograms over "number of thresholds passed", sized (n + 1) per axis.
+    std::vector<G4Accumulable<G4double>> energyHist;
+    std::vector<G4Accumulable<G4double>> trigHist;
+    std::vector<G4Accumulable<G4double>> optHist;
+
+    std::vector<G4double> crystalOnly;
+    std::vector<G4double> crystalAndVeto;
+    std::vector<G4double> effArea;
+    std::vector<G4double> crystalOnlyOpt;
+    std::vector<G4double> crystalAndVetoOpt;
+
+    template <class T>
+    static int Passed(const std::vector<T>& grid, const double value) {
+        return static_cast<int>(std::lower_bound(grid.begin(), grid.end(), value) - grid.begin());
+    }
+};
+
+#endif //THRESHOLDSCAN_HH
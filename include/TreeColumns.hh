@@ -0,0 +1,61 @@
+#ifndef TREECOLUMNS_HH
+#define TREECOLUMNS_HH
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <TTree.h>
+#include <TBranch.h>
+#include <TLeaf.h>
+#include <TLeafC.h>
+#include <TObjArray.h>
+
+// Binds every leaf of a tree to a typed buffer once, so entries can be read without
+// per-cell TLeaf::GetValue / dynamic_cast. Shared by the CSV and columnar exporters.
+class TreeColumns {
+public:
+    enum class Type : std::uint8_t { I8, U8, I16, U16, I32, U32, I64, U64, F32, F64, Str };
+
+    struct Column {
+        std::string name;
+        Type type;
+        int width;                 // values per entry; buffer size in chars for Str
+        std::vector<char> buffer;  // bound branch address
+    };
+
+    // Longest string a Str column can hold (G4 ntuple names are far shorter).
+    static constexpr int kMaxStringLen = 1024;
+
+    explicit TreeColumns(TTree* tree);
+    ~TreeColumns();
+
+    TreeColumns(const TreeColumns&) = delete;
+    TreeColumns& operator=(const TreeColumns&) = delete;
+
+    [[nodiscard]] Long64_t Entries() const { return tree->GetEntries(); }
+    void Read(Long64_t entry) { tree->GetEntry(entry); }
+
+    [[nodiscard]] const std::vector<Column>& Columns() const { return columns; }
+
+    template <typename T>
+    [[nodiscard]] T Value(const Column& c, const int k = 0) const {
+        T v;
+        std::memcpy(&v, c.buffer.data() + k * sizeof(T), sizeof(T));
+        return v;
+    }
+
+    [[nodiscard]] static const char* String(const Column& c) { return c.buffer.data(); }
+
+    static std::size_t Size(Type t);
+    static const char* Name(Type t);
+
+private:
+    TTree* tree;
+    std::vector<Column> columns;
+};
+
+#endif //TREECOLUMNS_HH
@@ -10,7 +10,9 @@
 #include <algorithm>
 #include <cctype>
 #include <cmath>
+#include <cstdint>
 #include <fstream>
+#include <iomanip>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -28,6 +30,12 @@ public:
 
     static G4double GetOr(const ConstMap& m, const std::string& key, G4double def);
 
+    // 64-bit FNV-1a of s as 16 hex digits; used to key on-disk caches.
+    static std::string HashHex(const std::string& s);
+
+    // Ranecu seed pair (zero-terminated) for stream `stream` of base seed `base`, via SplitMix64.
+    static void DeriveSeeds(std::uint64_t base, std::uint64_t stream, long seeds[3]);
+
     struct Table {
         std::vector<G4double> E;
         std::vector<G4double> V;
@@ -15,20 +15,34 @@ ActionInitialization::ActionInitialization(const G4double a, const G4double Emin
 void ActionInitialization::BuildForMaster() const {
     RunAction* runAct = new RunAction(area, EminMeV, EmaxMeV);
     SetUserAction(runAct);
+
+    // The subevent run manager tracks the parent events on the master; workers only get sub-events.
+    if (runManagerType == "subevent") BuildEventActions(runAct);
 }
 
 void ActionInitialization::Build() const {
     RunAction* runAct = new RunAction(area, EminMeV, EmaxMeV);
     SetUserAction(runAct);
 
+    BuildEventActions(runAct);
+}
+
+void ActionInitialization::BuildEventActions(RunAction* runAct) const {
     EventAction* eventAct = new EventAction(runAct->analysisManager, runAct);
     SetUserAction(eventAct);
 
     PrimaryGeneratorAction* primaryGenerator = new PrimaryGeneratorAction(fluxDirection, fluxType, eCrystalThreshold);
     SetUserAction(primaryGenerator);
 
-    if (saveSecondaries || savePhotons) {
-        SteppingAction* stepAct = new SteppingAction();
+    if (saveSecondaries || savePhotons || benchmark) {
+        SteppingAction* stepAct = new SteppingAction(runAct);
         SetUserAction(stepAct);
     }
+
+#ifdef NADYA_SUBEVENT_PARALLEL
+    if (runManagerType == "subevent" && G4Threading::IsMasterThread()) {
+        SetUserAction(new StackingAction);
+        runAct->SetEventAction(eventAct);
+    }
+#endif
 }
@@ -14,33 +14,60 @@ AnalysisManager::AnalysisManager(const std::string& fName, const int bins, const
 
 
 void AnalysisManager::Book() {
-    G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+    manager = G4AnalysisManager::Instance();
+    G4AnalysisManager* analysisManager = manager;
     analysisManager->SetDefaultFileType("root");
     analysisManager->SetFileName(fileName);
     analysisManager->SetVerboseLevel(0);
     analysisManager->SetNtupleActivation(true);
 
 #ifdef G4MULTITHREADED
-    analysisManager->SetNtupleMerging(true);
+    // Without merging every worker writes its own <file>_t<N>.root; PostProcessing chains them.
+    analysisManager->SetNtupleMerging(mergeNtuples);
 #endif
+    // With --async-output the ntuples belong to each worker's writer thread (NtupleWriter).
+    if (!asyncOutput) {
+        BookNtuples();
+    }
+    BookHists();
+}
+
+void AnalysisManager::BookNtuples() {
+    G4AnalysisManager* analysisManager = manager;
     edepNT = analysisManager->CreateNtuple("edep", "energy deposition per sensitive channel");
     analysisManager->CreateNtupleIColumn("eventID");
+    analysisManager->CreateNtupleIColumn("job");        // --job-index, (job, eventID) is unique across a split run
     analysisManager->CreateNtupleSColumn("det_name");
     analysisManager->CreateNtupleDColumn("edep_MeV");
+    analysisManager->CreateNtupleDColumn("weight");
     analysisManager->FinishNtuple(edepNT);
 
     // Per-fiber energy deposition in TOF fibers
     fiberHitsNT = analysisManager->CreateNtuple("fiber_hits", "energy deposition per TOF fiber");
     analysisManager->CreateNtupleIColumn("eventID");
+    analysisManager->CreateNtupleIColumn("job");
     analysisManager->CreateNtupleIColumn("plane");      // 0 = X, 1 = Y
     analysisManager->CreateNtupleIColumn("module");     // 0..fiberModuleCount-1
     analysisManager->CreateNtupleIColumn("layer");      // 0..fiberLayersPerPlane-1
     analysisManager->CreateNtupleIColumn("fiberIndex"); // index within layer
     analysisManager->CreateNtupleDColumn("edep_MeV");
+    analysisManager->CreateNtupleDColumn("weight");
     analysisManager->FinishNtuple(fiberHitsNT);
 
+    // Per-crystal energy deposition in the calorimeter
+    crystalHitsNT = analysisManager->CreateNtuple("crystal_hits", "energy deposition per calorimeter crystal");
+    analysisManager->CreateNtupleIColumn("eventID");
+    analysisManager->CreateNtupleIColumn("job");
+    analysisManager->CreateNtupleIColumn("ix");         // 0..rowsX-1
+    analysisManager->CreateNtupleIColumn("iy");         // 0..rowsY-1
+    analysisManager->CreateNtupleIColumn("channel");    // iy * rowsX + ix
+    analysisManager->CreateNtupleDColumn("edep_MeV");
+    analysisManager->CreateNtupleDColumn("weight");
+    analysisManager->FinishNtuple(crystalHitsNT);
+
     primaryNT = analysisManager->CreateNtuple("primary", "per-primary particles");
     analysisManager->CreateNtupleIColumn("eventID");
+    analysisManager->CreateNtupleIColumn("job");
     analysisManager->CreateNtupleSColumn("primary_name");
     analysisManager->CreateNtupleDColumn("E_MeV");
     analysisManager->CreateNtupleDColumn("dir_x");
@@ -49,16 +76,21 @@ void AnalysisManager::Book() {
     analysisManager->CreateNtupleDColumn("pos_x_mm");
     analysisManager->CreateNtupleDColumn("pos_y_mm");
     analysisManager->CreateNtupleDColumn("pos_z_mm");
+    analysisManager->CreateNtupleDColumn("weight");
+    analysisManager->CreateNtupleIColumn("seed1");   // Ranecu seeds of the event (--replay-events)
+    analysisManager->CreateNtupleIColumn("seed2");
     analysisManager->FinishNtuple(primaryNT);
 
     if (saveSecondaries) {
         interactionsNT = analysisManager->CreateNtuple("interactions",
                                                        "inelastic/compton/photo/conv vertices and secondaries");
         analysisManager->CreateNtupleIColumn("eventID");
+        analysisManager->CreateNtupleIColumn("job");
         analysisManager->CreateNtupleIColumn("trackID");
         analysisManager->CreateNtupleIColumn("parentID");
         analysisManager->CreateNtupleSColumn("process");
         analysisManager->CreateNtupleSColumn("volume_name");
+        analysisManager->CreateNtupleIColumn("volume_id");  // copy, or crystal/fiber channel when parameterised
         analysisManager->CreateNtupleDColumn("x_mm");
         analysisManager->CreateNtupleDColumn("y_mm");
         analysisManager->CreateNtupleDColumn("z_mm");
@@ -69,40 +101,50 @@ void AnalysisManager::Book() {
         analysisManager->CreateNtupleDColumn("sec_dir_x");
         analysisManager->CreateNtupleDColumn("sec_dir_y");
         analysisManager->CreateNtupleDColumn("sec_dir_z");
+        analysisManager->CreateNtupleDColumn("weight");
         analysisManager->FinishNtuple(interactionsNT);
 
         eventNT = analysisManager->CreateNtuple("event", "per-event summary");
         analysisManager->CreateNtupleIColumn("eventID");
+        analysisManager->CreateNtupleIColumn("job");
         analysisManager->CreateNtupleIColumn("n_primaries");
         analysisManager->CreateNtupleIColumn("n_interactions");
         analysisManager->CreateNtupleIColumn("n_edep_hits");
+        analysisManager->CreateNtupleDColumn("weight");
         analysisManager->FinishNtuple(eventNT);
     }
 
     if (useOptics) {
         SiPMEventNT = analysisManager->CreateNtuple("sipm_event", "SiPM p.e. per event");
         analysisManager->CreateNtupleIColumn("eventID");
+        analysisManager->CreateNtupleIColumn("job");
         analysisManager->CreateNtupleIColumn("npe_crystal");
         analysisManager->CreateNtupleIColumn("npe_veto");
         analysisManager->CreateNtupleIColumn("npe_bottom_veto");
+        analysisManager->CreateNtupleDColumn("weight");
         analysisManager->FinishNtuple(SiPMEventNT);
 
         SiPMChannelNT = analysisManager->CreateNtuple("sipm_ch", "SiPM p.e. per channel");
         analysisManager->CreateNtupleIColumn("eventID");
+        analysisManager->CreateNtupleIColumn("job");
         analysisManager->CreateNtupleSColumn("subdet");
         analysisManager->CreateNtupleIColumn("ch");
         analysisManager->CreateNtupleIColumn("npe");
+        analysisManager->CreateNtupleDColumn("weight");
         analysisManager->FinishNtuple(SiPMChannelNT);
         if (savePhotons) {
             photonsCountNT = analysisManager->CreateNtuple("photons_count", "generated photon count in volumes");
             analysisManager->CreateNtupleIColumn("eventID");
+            analysisManager->CreateNtupleIColumn("job");
             analysisManager->CreateNtupleIColumn("npe_crystal");
             analysisManager->CreateNtupleIColumn("npe_veto");
             analysisManager->CreateNtupleIColumn("npe_bottom_veto");
+            analysisManager->CreateNtupleDColumn("weight");
             analysisManager->FinishNtuple(photonsCountNT);
 
             photonsNT = analysisManager->CreateNtuple("photons", "photon register information");
             analysisManager->CreateNtupleIColumn("eventID");
+            analysisManager->CreateNtupleIColumn("job");
             analysisManager->CreateNtupleIColumn("photonID");
             analysisManager->CreateNtupleSColumn("det_name");
             analysisManager->CreateNtupleIColumn("det_ch");
@@ -110,9 +152,14 @@ void AnalysisManager::Book() {
             analysisManager->CreateNtupleDColumn("pos_x");
             analysisManager->CreateNtupleDColumn("pos_y");
             analysisManager->CreateNtupleDColumn("pos_z");
+            analysisManager->CreateNtupleDColumn("weight");
             analysisManager->FinishNtuple(photonsNT);
         }
     }
+}
+
+void AnalysisManager::BookHists() {
+    G4AnalysisManager* analysisManager = manager;
     if (xMin < xMax) {
         const G4String unit = "MeV";
         const G4String logScheme = "log";
@@ -152,37 +199,114 @@ void AnalysisManager::Book() {
 }
 
 void AnalysisManager::Open() {
-    G4AnalysisManager::Instance()->OpenFile(fileName);
+    manager->OpenFile(fileName);
+
+    // Every thread that simulates events gets its writer, so a worker without events still leaves its file.
+    if (asyncOutput && (G4Threading::IsWorkerThread() || !G4Threading::IsMultithreadedApplication())) {
+        if (!queue) {
+            const auto policy = outputBackpressure == "sleep"
+                                    ? OutputQueue::Backpressure::Sleep
+                                    : OutputQueue::Backpressure::Yield;
+            queue = std::make_unique<OutputQueue>(static_cast<std::size_t>(outputQueueDepth), policy);
+        }
+        queue->Start(NtupleWriter::PathFor(fileName, std::max(0, G4Threading::G4GetThreadId())));
+    }
 }
 
 void AnalysisManager::Close() {
-    G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
-    analysisManager->Write();
-    analysisManager->CloseFile();
+    if (queue) {
+        queue->Stop();
+    }
+    manager->Write();
+    manager->CloseFile();
+}
+
+void AnalysisManager::Submit(EventRecord& rec) {
+    if (queue && queue->IsRunning()) {
+        queue->Push(rec);
+        return;
+    }
+    WriteRecord(rec);
+    rec.Clear();
 }
 
-void AnalysisManager::FillEventRow(G4int eventID, G4int nPrimaries, G4int nInteractions, G4int nEdepHits) {
-    G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+void AnalysisManager::WriteRecord(const EventRecord& rec) {
+    const G4int eventID = rec.eventID;
+    const G4double w = rec.weight;
+
+    for (const auto& p : rec.primaries) {
+        FillPrimaryRow(eventID, p.name, p.E_MeV,
+                       G4ThreeVector(p.dir[0], p.dir[1], p.dir[2]),
+                       G4ThreeVector(p.pos_mm[0], p.pos_mm[1], p.pos_mm[2]), p.seeds[0], p.seeds[1], w);
+    }
+
+    for (const auto& r : rec.interactions) {
+        FillInteractionRow(eventID, r.trackID, r.parentID, r.process, r.volumeName, r.volumeID,
+                           G4ThreeVector(r.pos_mm[0], r.pos_mm[1], r.pos_mm[2]),
+                           r.t_ns, r.secIndex, r.secName, r.secE_MeV,
+                           G4ThreeVector(r.secDir[0], r.secDir[1], r.secDir[2]), w);
+    }
+
+    for (const auto& ph : rec.photons) {
+        FillPhotonRow(eventID, ph.photonID, ph.detName, ph.detCh, ph.energy_eV,
+                      ph.pos_mm[0], ph.pos_mm[1], ph.pos_mm[2], w);
+    }
+    if (rec.hasPhotonCount) {
+        FillPhotonCountRow(eventID, rec.photonCount[0], rec.photonCount[1], rec.photonCount[2], w);
+    }
+
+    for (const auto& f : rec.fiberHits) {
+        FillFiberHitRow(eventID, f.plane, f.module, f.layer, f.fiberIndex, f.edep_MeV, w);
+    }
+    for (const auto& c : rec.crystalHits) {
+        FillCrystalHitRow(eventID, c.ix, c.iy, c.channel, c.edep_MeV, w);
+    }
+    for (const auto& e : rec.edeps) {
+        FillEdepRow(eventID, e.detName, e.edep_MeV, w);
+    }
+
+    if (rec.hasEventRow) {
+        FillEventRow(eventID, rec.nPrimaries, rec.nInteractions, rec.nEdepHits, w);
+    }
+
+    if (rec.hasSiPMEvent) {
+        FillSiPMEventRow(eventID, rec.npe[0], rec.npe[1], rec.npe[2], w);
+    }
+    for (const auto& c : rec.sipmChannels) {
+        FillSiPMChannelRow(eventID, c.subdet, c.ch, c.npe, w);
+    }
+}
+
+void AnalysisManager::FillEventRow(G4int eventID, G4int nPrimaries, G4int nInteractions, G4int nEdepHits,
+                                   G4double weight) {
+    G4AnalysisManager* analysisManager = manager;
     analysisManager->FillNtupleIColumn(eventNT, 0, eventID);
-    analysisManager->FillNtupleIColumn(eventNT, 1, nPrimaries);
-    analysisManager->FillNtupleIColumn(eventNT, 2, nInteractions);
-    analysisManager->FillNtupleIColumn(eventNT, 3, nEdepHits);
+    analysisManager->FillNtupleIColumn(eventNT, 1, jobIndex);
+    analysisManager->FillNtupleIColumn(eventNT, 2, nPrimaries);
+    analysisManager->FillNtupleIColumn(eventNT, 3, nInteractions);
+    analysisManager->FillNtupleIColumn(eventNT, 4, nEdepHits);
+    analysisManager->FillNtupleDColumn(eventNT, 5, weight);
     analysisManager->AddNtupleRow(eventNT);
 }
 
 void AnalysisManager::FillPrimaryRow(G4int eventID, const G4String& primaryName,
                                      G4double E_MeV, const G4ThreeVector& dir,
-                                     const G4ThreeVector& pos_mm) {
-    G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+                                     const G4ThreeVector& pos_mm, G4int seed1, G4int seed2,
+                                     G4double weight) {
+    G4AnalysisManager* analysisManager = manager;
     analysisManager->FillNtupleIColumn(primaryNT, 0, eventID);
-    analysisManager->FillNtupleSColumn(primaryNT, 1, primaryName);
-    analysisManager->FillNtupleDColumn(primaryNT, 2, E_MeV);
-    analysisManager->FillNtupleDColumn(primaryNT, 3, dir.x());
-    analysisManager->FillNtupleDColumn(primaryNT, 4, dir.y());
-    analysisManager->FillNtupleDColumn(primaryNT, 5, dir.z());
-    analysisManager->FillNtupleDColumn(primaryNT, 6, pos_mm.x());
-    analysisManager->FillNtupleDColumn(primaryNT, 7, pos_mm.y());
-    analysisManager->FillNtupleDColumn(primaryNT, 8, pos_mm.z());
+    analysisManager->FillNtupleIColumn(primaryNT, 1, jobIndex);
+    analysisManager->FillNtupleSColumn(primaryNT, 2, primaryName);
+    analysisManager->FillNtupleDColumn(primaryNT, 3, E_MeV);
+    analysisManager->FillNtupleDColumn(primaryNT, 4, dir.x());
+    analysisManager->FillNtupleDColumn(primaryNT, 5, dir.y());
+    analysisManager->FillNtupleDColumn(primaryNT, 6, dir.z());
+    analysisManager->FillNtupleDColumn(primaryNT, 7, pos_mm.x());
+    analysisManager->FillNtupleDColumn(primaryNT, 8, pos_mm.y());
+    analysisManager->FillNtupleDColumn(primaryNT, 9, pos_mm.z());
+    analysisManager->FillNtupleDColumn(primaryNT, 10, weight);
+    analysisManager->FillNtupleIColumn(primaryNT, 11, seed1);
+    analysisManager->FillNtupleIColumn(primaryNT, 12, seed2);
     analysisManager->AddNtupleRow(primaryNT);
 }
 
@@ -190,77 +314,94 @@ void AnalysisManager::FillInteractionRow(G4int eventID,
                                          G4int trackID, G4int parentID,
                                          const G4String& process,
                                          const G4String& volumeName,
+                                         G4int volumeID,
                                          const G4ThreeVector& x_mm,
                                          G4double t_ns,
                                          G4int secIndex, const G4String& secName,
-                                         G4double secE_MeV, const G4ThreeVector& secDir) {
-    G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+                                         G4double secE_MeV, const G4ThreeVector& secDir,
+                                         G4double weight) {
+    G4AnalysisManager* analysisManager = manager;
     analysisManager->FillNtupleIColumn(interactionsNT, 0, eventID);
-    analysisManager->FillNtupleIColumn(interactionsNT, 1, trackID);
-    analysisManager->FillNtupleIColumn(interactionsNT, 2, parentID);
-    analysisManager->FillNtupleSColumn(interactionsNT, 3, process);
-    analysisManager->FillNtupleSColumn(interactionsNT, 4, volumeName);
-    analysisManager->FillNtupleDColumn(interactionsNT, 5, x_mm.x());
-    analysisManager->FillNtupleDColumn(interactionsNT, 6, x_mm.y());
-    analysisManager->FillNtupleDColumn(interactionsNT, 7, x_mm.z());
-    analysisManager->FillNtupleDColumn(interactionsNT, 8, t_ns);
-    analysisManager->FillNtupleIColumn(interactionsNT, 9, secIndex);
-    analysisManager->FillNtupleSColumn(interactionsNT, 10, secName);
-    analysisManager->FillNtupleDColumn(interactionsNT, 11, secE_MeV);
-    analysisManager->FillNtupleDColumn(interactionsNT, 12, secDir.x());
-    analysisManager->FillNtupleDColumn(interactionsNT, 13, secDir.y());
-    analysisManager->FillNtupleDColumn(interactionsNT, 14, secDir.z());
+    analysisManager->FillNtupleIColumn(interactionsNT, 1, jobIndex);
+    analysisManager->FillNtupleIColumn(interactionsNT, 2, trackID);
+    analysisManager->FillNtupleIColumn(interactionsNT, 3, parentID);
+    analysisManager->FillNtupleSColumn(interactionsNT, 4, process);
+    analysisManager->FillNtupleSColumn(interactionsNT, 5, volumeName);
+    analysisManager->FillNtupleIColumn(interactionsNT, 6, volumeID);
+    analysisManager->FillNtupleDColumn(interactionsNT, 7, x_mm.x());
+    analysisManager->FillNtupleDColumn(interactionsNT, 8, x_mm.y());
+    analysisManager->FillNtupleDColumn(interactionsNT, 9, x_mm.z());
+    analysisManager->FillNtupleDColumn(interactionsNT, 10, t_ns);
+    analysisManager->FillNtupleIColumn(interactionsNT, 11, secIndex);
+    analysisManager->FillNtupleSColumn(interactionsNT, 12, secName);
+    analysisManager->FillNtupleDColumn(interactionsNT, 13, secE_MeV);
+    analysisManager->FillNtupleDColumn(interactionsNT, 14, secDir.x());
+    analysisManager->FillNtupleDColumn(interactionsNT, 15, secDir.y());
+    analysisManager->FillNtupleDColumn(interactionsNT, 16, secDir.z());
+    analysisManager->FillNtupleDColumn(interactionsNT, 17, weight);
     analysisManager->AddNtupleRow(interactionsNT);
 }
 
-void AnalysisManager::FillEdepRow(G4int eventID, const G4String& det_name, G4double edep_MeV) {
-    G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+void AnalysisManager::FillEdepRow(G4int eventID, const G4String& det_name, G4double edep_MeV,
+                                      G4double weight) {
+    G4AnalysisManager* analysisManager = manager;
     analysisManager->FillNtupleIColumn(edepNT, 0, eventID);
-    analysisManager->FillNtupleSColumn(edepNT, 1, det_name);
-    analysisManager->FillNtupleDColumn(edepNT, 2, edep_MeV);
+    analysisManager->FillNtupleIColumn(edepNT, 1, jobIndex);
+    analysisManager->FillNtupleSColumn(edepNT, 2, det_name);
+    analysisManager->FillNtupleDColumn(edepNT, 3, edep_MeV);
+    analysisManager->FillNtupleDColumn(edepNT, 4, weight);
     analysisManager->AddNtupleRow(edepNT);
 }
 
-void AnalysisManager::FillSiPMEventRow(int eventID, int npeC, int npeV, int npeBV) {
-    auto* analysisManager = G4AnalysisManager::Instance();
+void AnalysisManager::FillSiPMEventRow(int eventID, int npeC, int npeV, int npeBV, G4double weight) {
+    auto* analysisManager = manager;
     analysisManager->FillNtupleIColumn(SiPMEventNT, 0, eventID);
-    analysisManager->FillNtupleIColumn(SiPMEventNT, 1, npeC);
-    analysisManager->FillNtupleIColumn(SiPMEventNT, 2, npeV);
-    analysisManager->FillNtupleIColumn(SiPMEventNT, 3, npeBV);
+    analysisManager->FillNtupleIColumn(SiPMEventNT, 1, jobIndex);
+    analysisManager->FillNtupleIColumn(SiPMEventNT, 2, npeC);
+    analysisManager->FillNtupleIColumn(SiPMEventNT, 3, npeV);
+    analysisManager->FillNtupleIColumn(SiPMEventNT, 4, npeBV);
+    analysisManager->FillNtupleDColumn(SiPMEventNT, 5, weight);
     analysisManager->AddNtupleRow(SiPMEventNT);
 }
 
-void AnalysisManager::FillSiPMChannelRow(int eventID, const G4String& subdet, int ch, int npe) {
-    auto* analysisManager = G4AnalysisManager::Instance();
+void AnalysisManager::FillSiPMChannelRow(int eventID, const G4String& subdet, int ch, int npe, G4double weight) {
+    auto* analysisManager = manager;
     analysisManager->FillNtupleIColumn(SiPMChannelNT, 0, eventID);
-    analysisManager->FillNtupleSColumn(SiPMChannelNT, 1, subdet);
-    analysisManager->FillNtupleIColumn(SiPMChannelNT, 2, ch);
-    analysisManager->FillNtupleIColumn(SiPMChannelNT, 3, npe);
+    analysisManager->FillNtupleIColumn(SiPMChannelNT, 1, jobIndex);
+    analysisManager->FillNtupleSColumn(SiPMChannelNT, 2, subdet);
+    analysisManager->FillNtupleIColumn(SiPMChannelNT, 3, ch);
+    analysisManager->FillNtupleIColumn(SiPMChannelNT, 4, npe);
+    analysisManager->FillNtupleDColumn(SiPMChannelNT, 5, weight);
     analysisManager->AddNtupleRow(SiPMChannelNT);
 }
 
 void AnalysisManager::FillPhotonCountRow(G4int eventID,
                                          G4int npeCrystal, G4int npeVeto,
-                                         G4int npeBottomVeto) {
-    G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+                                         G4int npeBottomVeto, G4double weight) {
+    G4AnalysisManager* analysisManager = manager;
     analysisManager->FillNtupleIColumn(photonsCountNT, 0, eventID);
-    analysisManager->FillNtupleIColumn(photonsCountNT, 1, npeCrystal);
-    analysisManager->FillNtupleIColumn(photonsCountNT, 2, npeVeto);
-    analysisManager->FillNtupleIColumn(photonsCountNT, 3, npeBottomVeto);
+    analysisManager->FillNtupleIColumn(photonsCountNT, 1, jobIndex);
+    analysisManager->FillNtupleIColumn(photonsCountNT, 2, npeCrystal);
+    analysisManager->FillNtupleIColumn(photonsCountNT, 3, npeVeto);
+    analysisManager->FillNtupleIColumn(photonsCountNT, 4, npeBottomVeto);
+    analysisManager->FillNtupleDColumn(photonsCountNT, 5, weight);
     analysisManager->AddNtupleRow(photonsCountNT);
 }
 
 void AnalysisManager::FillPhotonRow(G4int eventID, G4int photonID, const G4String& det_name, G4int det_ch,
-                                    G4double energy_eV, G4double x_mm, G4double y_mm, G4double z_mm) {
-    auto* analysisManager = G4AnalysisManager::Instance();
+                                    G4double energy_eV, G4double x_mm, G4double y_mm, G4double z_mm,
+                                    G4double weight) {
+    auto* analysisManager = manager;
     analysisManager->FillNtupleIColumn(photonsNT, 0, eventID);
-    analysisManager->FillNtupleIColumn(photonsNT, 1, photonID);
-    analysisManager->FillNtupleSColumn(photonsNT, 2, det_name);
-    analysisManager->FillNtupleIColumn(photonsNT, 3, det_ch);
-    analysisManager->FillNtupleDColumn(photonsNT, 4, energy_eV);
-    analysisManager->FillNtupleDColumn(photonsNT, 5, x_mm);
-    analysisManager->FillNtupleDColumn(photonsNT, 6, y_mm);
-    analysisManager->FillNtupleDColumn(photonsNT, 7, z_mm);
+    analysisManager->FillNtupleIColumn(photonsNT, 1, jobIndex);
+    analysisManager->FillNtupleIColumn(photonsNT, 2, photonID);
+    analysisManager->FillNtupleSColumn(photonsNT, 3, det_name);
+    analysisManager->FillNtupleIColumn(photonsNT, 4, det_ch);
+    analysisManager->FillNtupleDColumn(photonsNT, 5, energy_eV);
+    analysisManager->FillNtupleDColumn(photonsNT, 6, x_mm);
+    analysisManager->FillNtupleDColumn(photonsNT, 7, y_mm);
+    analysisManager->FillNtupleDColumn(photonsNT, 8, z_mm);
+    analysisManager->FillNtupleDColumn(photonsNT, 9, weight);
     analysisManager->AddNtupleRow(photonsNT);
 }
 
@@ -270,49 +411,70 @@ void AnalysisManager::FillFiberHitRow(G4int eventID,
                                       G4int module,
                                       G4int layer,
                                       G4int fiberIndex,
-                                      G4double edep_MeV) {
-    auto* analysisManager = G4AnalysisManager::Instance();
+                                      G4double edep_MeV,
+                                      G4double weight) {
+    auto* analysisManager = manager;
     analysisManager->FillNtupleIColumn(fiberHitsNT, 0, eventID);
-    analysisManager->FillNtupleIColumn(fiberHitsNT, 1, plane);
-    analysisManager->FillNtupleIColumn(fiberHitsNT, 2, module);
-    analysisManager->FillNtupleIColumn(fiberHitsNT, 3, layer);
-    analysisManager->FillNtupleIColumn(fiberHitsNT, 4, fiberIndex);
-    analysisManager->FillNtupleDColumn(fiberHitsNT, 5, edep_MeV);
+    analysisManager->FillNtupleIColumn(fiberHitsNT, 1, jobIndex);
+    analysisManager->FillNtupleIColumn(fiberHitsNT, 2, plane);
+    analysisManager->FillNtupleIColumn(fiberHitsNT, 3, module);
+    analysisManager->FillNtupleIColumn(fiberHitsNT, 4, layer);
+    analysisManager->FillNtupleIColumn(fiberHitsNT, 5, fiberIndex);
+    analysisManager->FillNtupleDColumn(fiberHitsNT, 6, edep_MeV);
+    analysisManager->FillNtupleDColumn(fiberHitsNT, 7, weight);
     analysisManager->AddNtupleRow(fiberHitsNT);
 }
 
 
+void AnalysisManager::FillCrystalHitRow(G4int eventID,
+                                        G4int ix,
+                                        G4int iy,
+                                        G4int channel,
+                                        G4double edep_MeV,
+                                        G4double weight) {
+    auto* analysisManager = manager;
+    analysisManager->FillNtupleIColumn(crystalHitsNT, 0, eventID);
+    analysisManager->FillNtupleIColumn(crystalHitsNT, 1, jobIndex);
+    analysisManager->FillNtupleIColumn(crystalHitsNT, 2, ix);
+    analysisManager->FillNtupleIColumn(crystalHitsNT, 3, iy);
+    analysisManager->FillNtupleIColumn(crystalHitsNT, 4, channel);
+    analysisManager->FillNtupleDColumn(crystalHitsNT, 5, edep_MeV);
+    analysisManager->FillNtupleDColumn(crystalHitsNT, 6, weight);
+    analysisManager->AddNtupleRow(crystalHitsNT);
+}
+
+
 void AnalysisManager::FillGenEnergyHist(G4double E_MeV, G4double weight) {
-    auto* analysisManager = G4AnalysisManager::Instance();
+    auto* analysisManager = manager;
     analysisManager->FillH1(genEnergyHist, E_MeV, weight);
 }
 
 void AnalysisManager::FillTrigEnergyHist(G4double E_MeV, G4double weight) {
-    auto* analysisManager = G4AnalysisManager::Instance();
+    auto* analysisManager = manager;
     analysisManager->FillH1(trigEnergyHist, E_MeV, weight);
 }
 
 void AnalysisManager::FillTrigOptEnergyHist(G4double E_MeV, G4double weight) {
-    auto* analysisManager = G4AnalysisManager::Instance();
+    auto* analysisManager = manager;
     analysisManager->FillH1(trigOptEnergyHist, E_MeV, weight);
 }
 
 void AnalysisManager::FillEffAreaHist(G4double E_MeV, G4double value) {
-    auto* analysisManager = G4AnalysisManager::Instance();
+    auto* analysisManager = manager;
     analysisManager->FillH1(effAreaHist, E_MeV, value);
 }
 
 void AnalysisManager::FillEffAreaOptHist(G4double E_MeV, G4double value) {
-    auto* analysisManager = G4AnalysisManager::Instance();
+    auto* analysisManager = manager;
     analysisManager->FillH1(effAreaOptHist, E_MeV, value);
 }
 
 void AnalysisManager::FillSensitivityHist(G4double E_MeV, G4double value) {
-    auto* analysisManager = G4AnalysisManager::Instance();
+    auto* analysisManager = manager;
     analysisManager->FillH1(sensitivityHist, E_MeV, value);
 }
 
 void AnalysisManager::FillSensitivityOptHist(G4double E_MeV, G4double value) {
-    auto* analysisManager = G4AnalysisManager::Instance();
+    auto* analysisManager = manager;
     analysisManager->FillH1(sensitivityOptHist, E_MeV, value);
 }
@@ -0,0 +1,118 @@
+#include "Bootstrap.hh"
+
+Bootstrap::Bootstrap(const int replicas, const std::uint64_t seed, const unsigned threads)
+    : replicas(replicas), seed(seed),
+      threads(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency())) {
+    if (replicas < 1) {
+        throw std::runtime_error("Bootstrap: replicas must be >= 1");
+    }
+}
+
+// SplitMix64 finaliser.
+std::uint64_t Bootstrap::Mix64(std::uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+int Bootstrap::Poisson1(const std::uint64_t event, const std::uint64_t replica) const {
+    // Cumulative Poisson(1) probabilities, k = 0..11 (P(k > 11) < 1e-9).
+    static constexpr double cdf[] = {
+        0.36787944117144233, 0.73575888234288467, 0.91969860292860584, 0.98101184312384626,
+        0.99634015317265634, 0.99940581518241826, 0.99991675885071200, 0.99998975080332530,
+        0.99999887479740200, 0.99999988857452160, 0.99999998995223360, 0.99999999916838920,
+    };
+
+    const std::uint64_t h = Mix64(seed ^ Mix64(event * static_cast<std::uint64_t>(replicas) + replica));
+    const double u = static_cast<double>(h >> 11) * 0x1.0p-53;
+
+    int k = 0;
+    while (k < 12 && u >= cdf[k]) ++k;
+    return k;
+}
+
+Bootstrap::Replicas Bootstrap::Resample(const Sample& sample) const {
+    Replicas out = Empty(sample.nBins);
+    Accumulate(sample, 0, out);
+    return out;
+}
+
+Bootstrap::Replicas Bootstrap::Empty(const int nBins) const {
+    Replicas out;
+    out.nBins = nBins;
+    out.replicas = replicas;
+    out.total.assign(static_cast<std::size_t>(nBins) * replicas, 0.0);
+    out.passed.assign(static_cast<std::size_t>(nBins) * replicas, 0.0);
+    return out;
+}
+
+void Bootstrap::Accumulate(const Sample& sample, const std::uint64_t firstEvent, Replicas& out) const {
+    const std::size_t nEvents = sample.bin.size();
+    if (sample.weight.size() != nEvents || sample.pass.size() != nEvents) {
+        throw std::runtime_error("Bootstrap: sample columns differ in length");
+    }
+    if (out.nBins != sample.nBins || out.replicas != replicas) {
+        throw std::runtime_error("Bootstrap: replica sums do not match the sample binning");
+    }
+
+    // Each thread owns a contiguous block of replicas and walks all events once.
+    const unsigned nThreads = std::min<unsigned>(threads, static_cast<unsigned>(replicas));
+    auto work = [&](const int r0, const int r1) {
+        std::vector<double> k(r1 - r0);
+        for (std::size_t e = 0; e < nEvents; ++e) {
+            const int b = sample.bin[e];
+            if (b < 0 || b >= sample.nBins) continue;
+
+            for (int r = r0; r < r1; ++r) {
+                k[r - r0] = sample.weight[e] * Poisson1(firstEvent + e, r);
+            }
+
+            double* total = out.total.data() + static_cast<std::size_t>(b) * replicas;
+            for (int r = r0; r < r1; ++r) total[r] += k[r - r0];
+
+            if (sample.pass[e]) {
+                double* passed = out.passed.data() + static_cast<std::size_t>(b) * replicas;
+                for (int r = r0; r < r1; ++r) passed[r] += k[r - r0];
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(nThreads);
+    for (unsigned t = 0; t < nThreads; ++t) {
+        const int r0 = static_cast<int>(static_cast<long long>(replicas) * t / nThreads);
+        const int r1 = static_cast<int>(static_cast<long long>(replicas) * (t + 1) / nThreads);
+        pool.emplace_back(work, r0, r1);
+    }
+    for (auto& th : pool) th.join();
+}
+
+Bootstrap::Band Bootstrap::Summarize(std::vector<double> values) {
+    Band band;
+    if (values.empty()) return band;
+
+    std::sort(values.begin(), values.end());
+    const auto n = static_cast<double>(values.size());
+
+    double sum = 0.0;
+    for (const double v : values) sum += v;
+    band.mean = sum / n;
+
+    double ss = 0.0;
+    for (const double v : values) ss += (v - band.mean) * (v - band.mean);
+    band.std = values.size() > 1 ? std::sqrt(ss / (n - 1.0)) : 0.0;
+
+    auto quantile = [&](const double q) {
+        const double pos = q * (n - 1.0);
+        const auto lo = static_cast<std::size_t>(pos);
+        const std::size_t hi = std::min(lo + 1, values.size() - 1);
+        return values[lo] + (pos - static_cast<double>(lo)) * (values[hi] - values[lo]);
+    };
+    band.p025 = quantile(0.025);
+    band.p16 = quantile(0.16);
+    band.p50 = quantile(0.5);
+    band.p84 = quantile(0.84);
+    band.p975 = quantile(0.975);
+    return band;
+}
@@ -0,0 +1,138 @@
+#include "ColumnarExport.hh"
+
+void ColumnarExport::Pad(std::ofstream& out, std::uint64_t& offset) {
+    static constexpr char zeros[kAlignment] = {};
+    const std::uint64_t rem = offset % kAlignment;
+    if (rem == 0) return;
+    out.write(zeros, static_cast<std::streamsize>(kAlignment - rem));
+    offset += kAlignment - rem;
+}
+
+std::string ColumnarExport::JsonString(const std::string& s) {
+    std::string r = "\"";
+    for (const char c : s) {
+        if (c == '"' || c == '\\') {
+            r += '\\';
+            r += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char esc[8];
+            std::snprintf(esc, sizeof(esc), "\\u%04x", static_cast<unsigned>(c));
+            r += esc;
+        } else {
+            r += c;
+        }
+    }
+    return r + "\"";
+}
+
+void ColumnarExport::Write(TTree* tree, const std::string& path, const Long64_t chunkRows) {
+    TreeColumns reader(tree);
+    const auto& cols = reader.Columns();
+    const std::size_t nCols = cols.size();
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) {
+        throw std::runtime_error("Cannot open output file: " + path);
+    }
+
+    char header[kAlignment] = {};
+    out.write(header, sizeof(header));
+    std::uint64_t offset = sizeof(header);
+
+    std::vector<ColumnChunk> chunk(nCols);
+    std::ostringstream chunkMeta;
+    Long64_t rows = 0;
+    bool firstChunk = true;
+
+    auto flush = [&]() {
+        if (rows == 0) return;
+        chunkMeta << (firstChunk ? "" : ",") << "{\"rows\":" << rows << ",\"buffers\":[";
+        for (std::size_t i = 0; i < nCols; ++i) {
+            Pad(out, offset);
+            auto& data = chunk[i].data;
+            out.write(data.data(), static_cast<std::streamsize>(data.size()));
+            chunkMeta << (i ? "," : "") << "[" << offset << "," << data.size() << "]";
+            offset += data.size();
+            data.clear();
+        }
+        chunkMeta << "]}";
+        firstChunk = false;
+        rows = 0;
+    };
+
+    const Long64_t nEntries = reader.Entries();
+    for (std::size_t i = 0; i < nCols; ++i) {
+        const std::size_t rowBytes = cols[i].type == TreeColumns::Type::Str
+                                         ? sizeof(std::uint32_t)
+                                         : TreeColumns::Size(cols[i].type) * cols[i].width;
+        chunk[i].data.reserve(rowBytes * std::min(chunkRows, std::max<Long64_t>(1, nEntries)));
+    }
+
+    for (Long64_t entry = 0; entry < nEntries; ++entry) {
+        reader.Read(entry);
+
+        for (std::size_t i = 0; i < nCols; ++i) {
+            const auto& c = cols[i];
+            auto& cc = chunk[i];
+            if (c.type == TreeColumns::Type::Str) {
+                const std::string s = TreeColumns::String(c);
+                auto [it, inserted] = cc.codes.try_emplace(s, static_cast<std::uint32_t>(cc.dictionary.size()));
+                if (inserted) cc.dictionary.push_back(s);
+                const std::uint32_t code = it->second;
+                const auto* p = reinterpret_cast<const char*>(&code);
+                cc.data.insert(cc.data.end(), p, p + sizeof(code));
+            } else {
+                const std::size_t n = TreeColumns::Size(c.type) * c.width;
+                cc.data.insert(cc.data.end(), c.buffer.data(), c.buffer.data() + n);
+            }
+        }
+
+        if (++rows == chunkRows) flush();
+    }
+    flush();
+
+    const std::uint16_t probe = 1;
+    const bool little = *reinterpret_cast<const std::uint8_t*>(&probe) == 1;
+
+    std::ostringstream meta;
+    meta << "{\"tree\":" << JsonString(tree->GetName())
+        << ",\"entries\":" << nEntries
+        << ",\"byte_order\":\"" << (little ? "little" : "big") << "\""
+        << ",\"alignment\":" << kAlignment
+        << ",\"columns\":[";
+    for (std::size_t i = 0; i < nCols; ++i) {
+        const auto& c = cols[i];
+        meta << (i ? "," : "") << "{\"name\":" << JsonString(c.name)
+            << ",\"type\":\"" << TreeColumns::Name(c.type) << "\"";
+        if (c.type == TreeColumns::Type::Str) {
+            meta << ",\"storage\":\"u32\",\"dictionary\":[";
+            const auto& dict = chunk[i].dictionary;
+            for (std::size_t k = 0; k < dict.size(); ++k) {
+                meta << (k ? "," : "") << JsonString(dict[k]);
+            }
+            meta << "]";
+        } else {
+            meta << ",\"width\":" << c.width;
+        }
+        meta << "}";
+    }
+    meta << "],\"chunks\":[" << chunkMeta.str() << "]}";
+
+    Pad(out, offset);
+    const std::string metaText = meta.str();
+    const std::uint64_t metaOffset = offset;
+    const std::uint64_t metaBytes = metaText.size();
+    out.write(metaText.data(), static_cast<std::streamsize>(metaText.size()));
+
+    std::memcpy(header, "NADYACOL", 8);
+    std::memcpy(header + 8, &kVersion, sizeof(kVersion));
+    std::memcpy(header + 12, &kAlignment, sizeof(kAlignment));
+    std::memcpy(header + 16, &metaOffset, sizeof(metaOffset));
+    std::memcpy(header + 24, &metaBytes, sizeof(metaBytes));
+    out.seekp(0);
+    out.write(header, sizeof(header));
+
+    if (!out) {
+        throw std::runtime_error("Failed writing columnar file: " + path);
+    }
+}
@@ -0,0 +1,16 @@
+#include "CrystalParameterisation.hh"
+
+CrystalParameterisation::CrystalParameterisation(const G4int rowsX, const G4int rowsY,
+                                                 const G4double pitchX, const G4double pitchY)
+    : rowsX(rowsX), rowsY(rowsY), pitchX(pitchX), pitchY(pitchY) {
+}
+
+void CrystalParameterisation::ComputeTransformation(const G4int copyNo, G4VPhysicalVolume* pv) const {
+    const G4int ix = copyNo % rowsX;
+    const G4int iy = copyNo / rowsX;
+
+    pv->SetTranslation(G4ThreeVector((ix - 0.5 * (rowsX - 1)) * pitchX,
+                                     (iy - 0.5 * (rowsY - 1)) * pitchY,
+                                     0.0));
+    pv->SetRotation(nullptr);
+}
@@ -53,8 +53,6 @@ void Detector::Construct() {
 }
 
 void Detector::ConstructShellAndContainers() {
-    const G4bool checkOverlaps = true;
-
     auto* instrumentSolid = new G4Box("InstrumentSolid",
                                       Envelope::halfX,
                                       Envelope::halfY,
@@ -73,8 +71,6 @@ void Detector::ConstructShellAndContainers() {
 }
 
 void Detector::ConstructVeto() {
-    const G4bool checkOverlaps = true;
-
     auto* acOuter = new G4Box("ACOuterBox",
                               VetoAC::outerHalfX,
                               VetoAC::outerHalfY,
@@ -99,8 +95,6 @@ void Detector::ConstructVeto() {
 }
 
 void Detector::ConstructPostCaloAC() {
-    const G4bool checkOverlaps = true;
-
     auto* acSolid = new G4Box("PostCaloACBox",
                               PostCaloAC::outerHalfX,
                               PostCaloAC::outerHalfY,
@@ -120,8 +114,6 @@ void Detector::ConstructPostCaloAC() {
 }
 
 void Detector::ConstructTOF() {
-    const G4bool checkOverlaps = true;
-
     // Lower layer in a pair: strips run along Y (segmentation in X).
     auto* xStripSolid = new G4Box("TriggerXStripSolid",
                                   Trigger::stripWidth / 2.0,
@@ -182,8 +174,6 @@ void Detector::ConstructTOF() {
 }
 
 void Detector::ConstructTOFFibers() {
-    const G4bool checkOverlaps = true;
-
     const G4double moduleHalfZ = TOFFibers::fiberModuleThickness / 2.0;
     const G4double planeHalfZ = moduleHalfZ / 2.0;
     const G4double coreRadius = std::max(0.0 * mm, TOFFibers::fiberRadius - TOFFibers::fiberCladThickness);
@@ -193,7 +183,7 @@ void Detector::ConstructTOFFibers() {
                                   TOFFibers::halfX,
                                   TOFFibers::halfY,
                                   moduleHalfZ);
-    auto* moduleLV = new G4LogicalVolume(moduleSolid, airMat, "FiberModuleLV");
+    moduleLV = new G4LogicalVolume(moduleSolid, airMat, "FiberModuleLV");
     moduleLV->SetVisAttributes(G4VisAttributes::GetInvisible());
 
     auto* planeSolid = new G4Box("FiberPlaneSolid",
@@ -205,8 +195,13 @@ void Detector::ConstructTOFFibers() {
     fiberPlaneXLV->SetVisAttributes(G4VisAttributes::GetInvisible());
     fiberPlaneYLV->SetVisAttributes(G4VisAttributes::GetInvisible());
 
-    auto* fiberCladX = new G4Tubs("TOFFiberCladdingX", coreRadius, TOFFibers::fiberRadius, TOFFibers::halfY, 0.0, 360.0 * deg);
-    auto* fiberCladY = new G4Tubs("TOFFiberCladdingY", coreRadius, TOFFibers::fiberRadius, TOFFibers::halfX, 0.0, 360.0 * deg);
+    // Parameterised planes need a single daughter per plane, so the cladding becomes a full
+    // cylinder with the core placed inside it; the fiber copy number then sits one level up.
+    const G4bool parameterised = Configuration::fiberPlacement == "parameterised";
+    const G4double cladInner = parameterised ? 0.0 : coreRadius;
+
+    auto* fiberCladX = new G4Tubs("TOFFiberCladdingX", cladInner, TOFFibers::fiberRadius, TOFFibers::halfY, 0.0, 360.0 * deg);
+    auto* fiberCladY = new G4Tubs("TOFFiberCladdingY", cladInner, TOFFibers::fiberRadius, TOFFibers::halfX, 0.0, 360.0 * deg);
     auto* fiberCoreX = new G4Tubs("TOFFiberCoreX", 0.0, coreRadius, TOFFibers::halfY, 0.0, 360.0 * deg);
     auto* fiberCoreY = new G4Tubs("TOFFiberCoreY", 0.0, coreRadius, TOFFibers::halfX, 0.0, 360.0 * deg);
 
@@ -245,62 +240,83 @@ void Detector::ConstructTOFFibers() {
                       0,
                       checkOverlaps);
 
-    const G4double step = 2.0 * TOFFibers::fiberRadius + TOFFibers::fiberStripGap;
-    const G4int maxRowsX = static_cast<G4int>(std::floor(TOFFibers::sizeX / step));
-    const G4int maxRowsY = static_cast<G4int>(std::floor(TOFFibers::sizeY / step));
-    const G4int rowsXBase = std::max(0, std::min(TOFFibers::fiberRowsX, maxRowsX));
-    const G4int rowsYBase = std::max(0, std::min(TOFFibers::fiberRowsY, maxRowsY));
-    const G4double usedXBase = rowsXBase * step;
-    const G4double usedYBase = rowsYBase * step;
+    const G4double step = TOFFibers::step;
+    const G4int rowsX = TOFFibers::usedRowsX;
+    const G4int rowsY = TOFFibers::usedRowsY;
+    const G4double usedXBase = rowsX * step;
+    const G4double usedYBase = rowsY * step;
     const G4double leftGuard = TOFFibers::fiberRadius;
     const G4double marginXBase = std::max((TOFFibers::sizeX - usedXBase) / 2.0, leftGuard);
     const G4double marginYBase = std::max((TOFFibers::sizeY - usedYBase) / 2.0, leftGuard);
 
+    std::vector<G4double> layerZ;
+    std::vector<G4double> firstX;
+    std::vector<G4double> firstY;
     for (G4int l = 0; l < TOFFibers::fiberLayersPerPlane; ++l) {
-        const G4double zLayer = -planeHalfZ + TOFFibers::fiberRadius + l * centerDist;
         const G4double rowShift = (l % 3 == 1) ? (-TOFFibers::fiberRadius) : 0.0;
-        const G4int rowsX = rowsXBase;
-        const G4int rowsY = rowsYBase;
-
-        for (G4int i = 0; i < rowsX; ++i) {
-            const G4double x = -TOFFibers::halfX + marginXBase + TOFFibers::fiberRadius + rowShift + i * step;
-            const G4int copyNo = l * rowsX + i;
-            new G4PVPlacement(rotAlongY,
-                              G4ThreeVector(x, 0.0, zLayer),
-                              fiberCladXLV,
-                              "TOFFiberXCladPV",
-                              fiberPlaneXLV,
-                              false,
-                              copyNo,
-                              checkOverlaps);
-            new G4PVPlacement(rotAlongY,
-                              G4ThreeVector(x, 0.0, zLayer),
-                              coordDetectorLV,
-                              "TOFFiberXCorePV",
-                              fiberPlaneXLV,
-                              false,
-                              copyNo,
-                              checkOverlaps);
+        layerZ.push_back(-planeHalfZ + TOFFibers::fiberRadius + l * centerDist);
+        firstX.push_back(-TOFFibers::halfX + marginXBase + TOFFibers::fiberRadius + rowShift);
+        firstY.push_back(-TOFFibers::halfY + marginYBase + TOFFibers::fiberRadius + rowShift);
+    }
+
+    if (parameterised) {
+        new G4PVPlacement(nullptr, G4ThreeVector(), coordDetectorLV, "TOFFiberXCorePV",
+                          fiberCladXLV, false, 0, checkOverlaps);
+        new G4PVPlacement(nullptr, G4ThreeVector(), fiberCoreLV, "TOFFiberYCorePV",
+                          fiberCladYLV, false, 0, checkOverlaps);
+
+        auto* paramX = new FiberParameterisation(kXAxis, rowsX, step, firstX, layerZ, rotAlongY);
+        auto* paramY = new FiberParameterisation(kYAxis, rowsY, step, firstY, layerZ, rotAlongX);
+        if (paramX->GetCopies() > 0) {
+            new G4PVParameterised("TOFFiberXCladPV", fiberCladXLV, fiberPlaneXLV,
+                                  kXAxis, paramX->GetCopies(), paramX);
         }
-        for (G4int i = 0; i < rowsY; ++i) {
-            const G4double y = -TOFFibers::halfY + marginYBase + TOFFibers::fiberRadius + rowShift + i * step;
-            const G4int copyNo = l * rowsY + i;
-            new G4PVPlacement(rotAlongX,
-                              G4ThreeVector(0.0, y, zLayer),
-                              fiberCladYLV,
-                              "TOFFiberYCladPV",
-                              fiberPlaneYLV,
-                              false,
-                              copyNo,
-                              checkOverlaps);
-            new G4PVPlacement(rotAlongX,
-                              G4ThreeVector(0.0, y, zLayer),
-                              fiberCoreLV,
-                              "TOFFiberYCorePV",
-                              fiberPlaneYLV,
-                              false,
-                              copyNo,
-                              checkOverlaps);
+        if (paramY->GetCopies() > 0) {
+            new G4PVParameterised("TOFFiberYCladPV", fiberCladYLV, fiberPlaneYLV,
+                                  kYAxis, paramY->GetCopies(), paramY);
+        }
+    } else {
+        for (G4int l = 0; l < TOFFibers::fiberLayersPerPlane; ++l) {
+            for (G4int i = 0; i < rowsX; ++i) {
+                const G4double x = firstX[l] + i * step;
+                const G4int copyNo = l * rowsX + i;
+                new G4PVPlacement(rotAlongY,
+                                  G4ThreeVector(x, 0.0, layerZ[l]),
+                                  fiberCladXLV,
+                                  "TOFFiberXCladPV",
+                                  fiberPlaneXLV,
+                                  false,
+                                  copyNo,
+                                  checkOverlaps);
+                new G4PVPlacement(rotAlongY,
+                                  G4ThreeVector(x, 0.0, layerZ[l]),
+                                  coordDetectorLV,
+                                  "TOFFiberXCorePV",
+                                  fiberPlaneXLV,
+                                  false,
+                                  copyNo,
+                                  checkOverlaps);
+            }
+            for (G4int i = 0; i < rowsY; ++i) {
+                const G4double y = firstY[l] + i * step;
+                const G4int copyNo = l * rowsY + i;
+                new G4PVPlacement(rotAlongX,
+                                  G4ThreeVector(0.0, y, layerZ[l]),
+                                  fiberCladYLV,
+                                  "TOFFiberYCladPV",
+                                  fiberPlaneYLV,
+                                  false,
+                                  copyNo,
+                                  checkOverlaps);
+                new G4PVPlacement(rotAlongX,
+                                  G4ThreeVector(0.0, y, layerZ[l]),
+                                  fiberCoreLV,
+                                  "TOFFiberYCorePV",
+                                  fiberPlaneYLV,
+                                  false,
+                                  copyNo,
+                                  checkOverlaps);
+            }
         }
     }
 
@@ -320,35 +336,32 @@ void Detector::ConstructTOFFibers() {
 }
 
 void Detector::ConstructCalorimeter() {
-    const G4bool checkOverlaps = true;
+    // The array sits in its own container, so the parameterised crystals are its only daughter.
+    auto* arraySolid = new G4Box("CalorimeterArraySolid",
+                                 Calorimeter::totalWidth() / 2.0,
+                                 Calorimeter::totalLength() / 2.0,
+                                 Calorimeter::crystalHeight / 2.0);
+    calorimeterArrayLV = new G4LogicalVolume(arraySolid, airMat, "CalorimeterArrayLV");
+    calorimeterArrayLV->SetVisAttributes(G4VisAttributes::GetInvisible());
+    new G4PVPlacement(nullptr,
+                      G4ThreeVector(0, 0, ZInInstrument(Calorimeter::centerZ())),
+                      calorimeterArrayLV,
+                      "CalorimeterArrayPV",
+                      cubeOuterLV,
+                      false,
+                      0,
+                      checkOverlaps);
 
     auto* crystalSolid = new G4Box("CsICrystalSolid",
                                    Calorimeter::crystalWidth / 2.0,
                                    Calorimeter::crystalLength / 2.0,
                                    Calorimeter::crystalHeight / 2.0);
+    crystalLV = new G4LogicalVolume(crystalSolid, calorimeterMat, "CsICrystalLV");
+    crystalLV->SetVisAttributes(visCalorimeter);
 
-    for (G4int ix = 0; ix < Calorimeter::rowsX; ++ix) {
-        for (G4int iy = 0; iy < Calorimeter::rowsY; ++iy) {
-            const G4String crystalName = "CsICrystal_" + std::to_string(ix) + "_" + std::to_string(iy);
-            auto* crystalLV = new G4LogicalVolume(crystalSolid, calorimeterMat, crystalName + "LV");
-            crystalLV->SetVisAttributes(visCalorimeter);
-
-            const G4double x = -Calorimeter::totalWidth() / 2.0
-                               + (ix + 0.5) * Calorimeter::crystalWidth
-                               + ix * Calorimeter::gap;
-            const G4double y = -Calorimeter::totalLength() / 2.0
-                               + (iy + 0.5) * Calorimeter::crystalLength
-                               + iy * Calorimeter::gap;
-
-            new G4PVPlacement(nullptr,
-                              G4ThreeVector(x, y, ZInInstrument(Calorimeter::centerZ())),
-                              crystalLV,
-                              crystalName + "PV",
-                              cubeOuterLV,
-                              false,
-                              ix * 10 + iy,
-                              checkOverlaps);
-        }
-    }
+    auto* param = new CrystalParameterisation(Calorimeter::rowsX, Calorimeter::rowsY,
+                                              Calorimeter::crystalWidth + Calorimeter::gap,
+                                              Calorimeter::crystalLength + Calorimeter::gap);
+    new G4PVParameterised("CsICrystalPV", crystalLV, calorimeterArrayLV, kUndefined, param->GetCopies(), param);
 }
 
@@ -16,22 +16,61 @@ EventAction::EventAction(AnalysisManager* an, RunAction* r) : analysisManager(an
         {"PostCaloACSD/EdepHits",    9, "PostCaloAC"},
     };
     HCIDs.assign(detMap.size(), -1);
+
+    if (storeTrigger == "all") storeTrig = StoreTrigger::All;
+    else if (storeTrigger == "tof") storeTrig = StoreTrigger::TOF;
+    else if (storeTrigger == "crystal") storeTrig = StoreTrigger::Crystal;
+    else if (storeTrigger == "crystal_only") storeTrig = StoreTrigger::CrystalOnly;
+    else if (storeTrigger == "crystal_opt") storeTrig = StoreTrigger::CrystalOpt;
+    else {
+        G4Exception("EventAction::EventAction", "StoreTrigger", FatalException,
+                    ("Unknown storage trigger: " + storeTrigger +
+                        ".\nAvailable triggers: all, tof, crystal, crystal_only, crystal_opt").c_str());
+    }
+}
+
+bool EventAction::PassesStoreTrigger_() const {
+    switch (storeTrig) {
+    case StoreTrigger::TOF:
+        return HasTOFAndNoAC();
+    case StoreTrigger::Crystal:
+        return hasCrystal;
+    case StoreTrigger::CrystalOnly:
+        return hasCrystal && !hasVeto;
+    case StoreTrigger::CrystalOpt:
+        return hasCrystalOpt && !hasVetoOpt;
+    default:
+        return true;
+    }
 }
 
 void EventAction::BeginOfEventAction(const G4Event*) {
+    if (SiPMOpticalSD::InSubEvent()) return;
     nPrimaries = 0;
     nInteractions = 0;
     nEdepHits = 0;
     hasCrystal = false;
     hasVeto = false;
+    hasCrystalOpt = false;
+    hasVetoOpt = false;
     hasTrigger1Lower = false;
     hasTrigger1Upper = false;
     hasTrigger2Lower = false;
     hasTrigger2Upper = false;
+    scanEvent = {};
 }
 
 void EventAction::EndOfEventAction(const G4Event* evt) {
+    // Sub-event counts travel to the parent event through SiPMSubEventInfo instead.
+    if (SiPMOpticalSD::InSubEvent()) {
+        interBuf.clear();
+        photonBuf.clear();
+        photonCountBuf = {0, 0, 0};
+        return;
+    }
+
     const int eventID = evt->GetEventID();
+    record.eventID = eventID;
 
     WritePrimaries_(eventID);
     nPrimaries = static_cast<int>(primBuf.size());
@@ -59,7 +98,10 @@ void EventAction::EndOfEventAction(const G4Event* evt) {
     nEdepHits = WriteEdepFromSD_(evt, eventID);
 
     if (saveSecondaries) {
-        analysisManager->FillEventRow(eventID, nPrimaries, nInteractions, nEdepHits);
+        record.hasEventRow = true;
+        record.nPrimaries = nPrimaries;
+        record.nInteractions = nInteractions;
+        record.nEdepHits = nEdepHits;
     }
 
     if (run and hasCrystal && !hasVeto) run->AddCrystalOnly(1);
@@ -79,7 +121,23 @@ void EventAction::EndOfEventAction(const G4Event* evt) {
                 // analysisManager->FillTrigOptEnergyHist(primaryE_MeV, 1.0);
             }
         }
-        WriteSiPMFromSD_(eventID);
+    }
+
+    // Loader only accepts prescales >= 1, so every dropped event is represented by a stored one. The draw
+    // comes from the event's own seeded stream, so the same events are kept whatever the thread count.
+    const double draw = G4UniformRand();
+#ifdef NADYA_SUBEVENT_PARALLEL
+    if (runManagerType == "subevent") {
+        DeferEvent_(primaryE_MeV, draw);
+        return;
+    }
+#endif
+    if (useOptics) WriteSiPMFromSD_(eventID);
+    FinishEvent_(primaryE_MeV, draw);
+}
+
+void EventAction::FinishEvent_(const double primaryE_MeV, const double draw) {
+    if (useOptics) {
         if (run and hasCrystalOpt && !hasVetoOpt) run->AddCrystalOnlyOpt(1);
         if (run and hasCrystalOpt && hasVetoOpt) run->AddCrystalAndVetoOpt(1);
 
@@ -87,44 +145,149 @@ void EventAction::EndOfEventAction(const G4Event* evt) {
             if (run and HasTOFAndNoAC()) run->AddTriggeredCrystalOnlyOpt(primaryE_MeV);
         }
     }
+
+    if (run and thresholdScan) {
+        scanEvent.tof = hasTrigger1Lower && hasTrigger1Upper && hasTrigger2Lower && hasTrigger2Upper;
+        run->AddScanEvent(scanEvent, primaryE_MeV);
+    }
+
+    if (!PassesStoreTrigger_()) {
+        if (draw * storePrescale >= 1.0) {
+            record.Clear();
+            return;
+        }
+        record.weight = storePrescale;
+    }
+
+    analysisManager->Submit(record);
 }
 
-void EventAction::WritePrimaries_(int eventID) {
+#ifdef NADYA_SUBEVENT_PARALLEL
+// Called on a worker thread as each optical photon sub-event finishes. Sub-events of different parent events
+// finish interleaved and possibly after their parent's EndOfEventAction, so the sums are kept per event ID.
+void EventAction::MergeSubEvent(G4Event* masterEvent, const G4Event* subEvent) {
+    const auto* info = dynamic_cast<const SiPMSubEventInfo*>(subEvent->GetUserInformation());
+    if (!info) return;
+
+    G4AutoLock lock(&mergeMutex);
+    subEventSums[masterEvent->GetEventID()].Add(*info);
+}
+
+// The parent's SiPM counts are only final once all of its sub-events are merged, so everything that depends
+// on them waits for the end of the run. Records of all events are held until then.
+void EventAction::DeferEvent_(const double primaryE_MeV, const double draw) {
+    DeferredEvent& d = deferred[record.eventID];
+    std::swap(d.record, record);
+    record.Clear();
+    d.hasCrystal = hasCrystal;
+    d.hasVeto = hasVeto;
+    d.hasTrigger1Lower = hasTrigger1Lower;
+    d.hasTrigger1Upper = hasTrigger1Upper;
+    d.hasTrigger2Lower = hasTrigger2Lower;
+    d.hasTrigger2Upper = hasTrigger2Upper;
+    d.scanEvent = scanEvent;
+    d.primaryE_MeV = primaryE_MeV;
+    d.draw = draw;
+}
+
+void EventAction::FinishDeferredEvents() {
+    G4AutoLock lock(&mergeMutex);
+    const SiPMSubEventInfo none;
+    for (auto& [eventID, d] : deferred) {
+        std::swap(record, d.record);
+        hasCrystal = d.hasCrystal;
+        hasVeto = d.hasVeto;
+        hasTrigger1Lower = d.hasTrigger1Lower;
+        hasTrigger1Upper = d.hasTrigger1Upper;
+        hasTrigger2Lower = d.hasTrigger2Lower;
+        hasTrigger2Upper = d.hasTrigger2Upper;
+        scanEvent = d.scanEvent;
+        hasCrystalOpt = false;
+        hasVetoOpt = false;
+
+        const auto it = subEventSums.find(eventID);
+        const SiPMSubEventInfo& sum = it != subEventSums.end() ? it->second : none;
+        WriteSiPM_(sum.npeCrystal, sum.npeVeto, sum.npeBottom, sum.perChCrystal, sum.perChVeto, sum.perChBottom);
+        if (savePhotons) {
+            photonBuf = sum.photons;
+            WritePhotons_(eventID);
+            photonBuf.clear();
+        }
+        FinishEvent_(d.primaryE_MeV, d.draw);
+        record.Clear();
+    }
+    deferred.clear();
+    subEventSums.clear();
+}
+#endif
+
+void EventAction::WritePrimaries_(int) {
     for (const auto& p : primBuf) {
-        analysisManager->FillPrimaryRow(eventID, p.name, p.E_MeV, p.dir, p.pos_mm);
+        PrimaryRow& row = record.primaries.emplace_back();
+        row.name = p.name;
+        row.E_MeV = p.E_MeV;
+        row.dir[0] = p.dir.x();
+        row.dir[1] = p.dir.y();
+        row.dir[2] = p.dir.z();
+        row.pos_mm[0] = p.pos_mm.x();
+        row.pos_mm[1] = p.pos_mm.y();
+        row.pos_mm[2] = p.pos_mm.z();
+        row.seeds[0] = static_cast<G4int>(p.seeds[0]);
+        row.seeds[1] = static_cast<G4int>(p.seeds[1]);
     }
 }
 
-int EventAction::WriteInteractions_(int eventID) {
+int EventAction::WriteInteractions_(int) {
     if (saveSecondaries) {
+        record.interactions.reserve(record.interactions.size() + interBuf.size());
         for (const auto& r : interBuf) {
-            analysisManager->FillInteractionRow(eventID,
-                                                r.trackID, r.parentID,
-                                                r.process, r.volumeName, r.pos_mm,
-                                                r.t_ns,
-                                                r.secIndex, r.secName,
-                                                r.secE_MeV, r.secDir);
+            InteractionRow& row = record.interactions.emplace_back();
+            row.trackID = r.trackID;
+            row.parentID = r.parentID;
+            row.process = r.process;
+            row.volumeName = r.volumeName;
+            row.volumeID = r.volumeID;
+            row.pos_mm[0] = r.pos_mm.x();
+            row.pos_mm[1] = r.pos_mm.y();
+            row.pos_mm[2] = r.pos_mm.z();
+            row.t_ns = r.t_ns;
+            row.secIndex = r.secIndex;
+            row.secName = r.secName;
+            row.secE_MeV = r.secE_MeV;
+            row.secDir[0] = r.secDir.x();
+            row.secDir[1] = r.secDir.y();
+            row.secDir[2] = r.secDir.z();
         }
     }
     return static_cast<int>(interBuf.size());
 }
 
-int EventAction::WritePhotonsCount_(int eventID) {
+int EventAction::WritePhotonsCount_(int) {
     if (savePhotons) {
-        analysisManager->FillPhotonCountRow(eventID, photonCountBuf[0], photonCountBuf[1], photonCountBuf[2]);
+        record.hasPhotonCount = true;
+        record.photonCount[0] = photonCountBuf[0];
+        record.photonCount[1] = photonCountBuf[1];
+        record.photonCount[2] = photonCountBuf[2];
     }
     return static_cast<int>(photonCountBuf.size());
 }
 
-int EventAction::WritePhotons_(int eventID) {
+int EventAction::WritePhotons_(int) {
+    record.photons.reserve(record.photons.size() + photonBuf.size());
     for (const auto& photon : photonBuf) {
-        analysisManager->FillPhotonRow(eventID, photon.photonID, photon.detName, photon.detCh, photon.energy,
-                                       photon.pos_mm.x(), photon.pos_mm.y(), photon.pos_mm.z());
+        PhotonRow& row = record.photons.emplace_back();
+        row.photonID = photon.photonID;
+        row.detName = photon.detName;
+        row.detCh = photon.detCh;
+        row.energy_eV = photon.energy;
+        row.pos_mm[0] = photon.pos_mm.x();
+        row.pos_mm[1] = photon.pos_mm.y();
+        row.pos_mm[2] = photon.pos_mm.z();
     }
     return static_cast<int>(photonBuf.size());
 }
 
-int EventAction::WriteEdepFromSD_(const G4Event* evt, int eventID) {
+int EventAction::WriteEdepFromSD_(const G4Event* evt, int) {
     auto* hce = evt->GetHCofThisEvent();
     if (!hce) return 0;
 
@@ -153,6 +316,12 @@ int EventAction::WriteEdepFromSD_(const G4Event* evt, int eventID) {
             auto* h = (*hc)[j];
             double edep_MeV = h->edep / MeV;
 
+            if (det_name == "Crystal") {
+                scanEvent.crystalEdepMax = std::max(scanEvent.crystalEdepMax, edep_MeV);
+            } else if (det_name == "Veto" or det_name == "PostCaloAC") {
+                scanEvent.vetoEdepMax = std::max(scanEvent.vetoEdepMax, edep_MeV);
+            }
+
             if ((det_name == "Veto" or det_name == "PostCaloAC") and edep_MeV <= eVetoThreshold) {
                 edep_MeV = 0;
             }
@@ -170,20 +339,19 @@ int EventAction::WriteEdepFromSD_(const G4Event* evt, int eventID) {
                 else if (det_name == "Trigger2Upper") hasTrigger2Upper = true;
 
                 // Per-fiber ntuple: only for TOF fibers where metadata is available.
-                if (analysisManager &&
-                    h->plane >= 0 &&
+                if (h->plane >= 0 &&
                     h->module >= 0 &&
                     h->layer >= 0 &&
                     h->fiberIndex >= 0) {
-                    analysisManager->FillFiberHitRow(eventID,
-                                                     h->plane,
-                                                     h->module,
-                                                     h->layer,
-                                                     h->fiberIndex,
-                                                     edep_MeV);
+                    record.fiberHits.push_back({h->plane, h->module, h->layer, h->fiberIndex, edep_MeV});
+                }
+                if (h->crystalX >= 0) {
+                    record.crystalHits.push_back({h->crystalX, h->crystalY, h->volumeID, edep_MeV});
                 }
 
-                analysisManager->FillEdepRow(eventID, det_name, edep_MeV);
+                EdepRow& row = record.edeps.emplace_back();
+                row.detName = det_name;
+                row.edep_MeV = edep_MeV;
             }
         }
         nHitsTotal += static_cast<int>(N);
@@ -192,7 +360,7 @@ int EventAction::WriteEdepFromSD_(const G4Event* evt, int eventID) {
     return nHitsTotal;
 }
 
-void EventAction::WriteSiPMFromSD_(int eventID) {
+void EventAction::WriteSiPMFromSD_(int) {
     auto* sdm = G4SDManager::GetSDMpointer();
     if (!sdm) return;
 
@@ -200,9 +368,17 @@ void EventAction::WriteSiPMFromSD_(int eventID) {
     auto* sipmSD = dynamic_cast<SiPMOpticalSD*>(sdBase);
     if (!sipmSD) return;
 
-    int npeC = sipmSD->GetNpeCrystal();
-    int npeV = sipmSD->GetNpeVeto();
-    int npeB = sipmSD->GetNpeBottomVeto();
+    WriteSiPM_(sipmSD->GetNpeCrystal(), sipmSD->GetNpeVeto(), sipmSD->GetNpeBottomVeto(),
+               sipmSD->GetPerChannelCrystal(), sipmSD->GetPerChannelVeto(), sipmSD->GetPerChannelBottom());
+}
+
+void EventAction::WriteSiPM_(int npeC, int npeV, int npeB, const std::unordered_map<int,int>& perChCrystal,
+                             const std::unordered_map<int,int>& perChVeto,
+                             const std::unordered_map<int,int>& perChBottom) {
+    scanEvent.hasOptics = true;
+    scanEvent.npeCrystal = npeC;
+    scanEvent.npeVeto = npeV;
+    scanEvent.npeBottom = npeB;
 
     npeC = npeC > oCrystalThreshold ? npeC : 0;
     npeV = npeV > oVetoThreshold ? npeV : 0;
@@ -211,24 +387,21 @@ void EventAction::WriteSiPMFromSD_(int eventID) {
     if (npeC > 0) MarkCrystalOpt();
     if (npeV > 0 or npeB > 0) MarkVetoOpt();
 
-    analysisManager->FillSiPMEventRow(eventID, npeC, npeV, npeB);
+    record.hasSiPMEvent = true;
+    record.npe[0] = npeC;
+    record.npe[1] = npeV;
+    record.npe[2] = npeB;
 
-    for (const auto& kv : sipmSD->GetPerChannelCrystal()) {
-        const int ch = kv.first;
-        const int npe = kv.second;
-        analysisManager->FillSiPMChannelRow(eventID, "Crystal", ch, npe);
+    for (const auto& kv : perChCrystal) {
+        record.sipmChannels.push_back({"Crystal", kv.first, kv.second});
     }
 
-    for (const auto& kv : sipmSD->GetPerChannelVeto()) {
-        const int ch = kv.first;
-        const int npe = kv.second;
-        analysisManager->FillSiPMChannelRow(eventID, "Veto", ch, npe);
+    for (const auto& kv : perChVeto) {
+        record.sipmChannels.push_back({"Veto", kv.first, kv.second});
     }
 
-    for (const auto& kv : sipmSD->GetPerChannelBottom()) {
-        const int ch = kv.first;
-        const int npe = kv.second;
-        analysisManager->FillSiPMChannelRow(eventID, "BottomVeto", ch, npe);
+    for (const auto& kv : perChBottom) {
+        record.sipmChannels.push_back({"BottomVeto", kv.first, kv.second});
     }
 }
 
@@ -0,0 +1,19 @@
+#include "FiberParameterisation.hh"
+
+FiberParameterisation::FiberParameterisation(const EAxis axis, const G4int rows, const G4double step,
+                                             std::vector<G4double> firstOffset, std::vector<G4double> layerZ,
+                                             G4RotationMatrix* rotation)
+    : axis(axis), rows(rows), step(step),
+      firstOffset(std::move(firstOffset)), layerZ(std::move(layerZ)), rotation(rotation) {
+}
+
+void FiberParameterisation::ComputeTransformation(const G4int copyNo, G4VPhysicalVolume* pv) const {
+    const G4int l = copyNo / rows;
+    const G4int i = copyNo % rows;
+    const G4double offset = firstOffset[l] + i * step;
+
+    pv->SetTranslation(axis == kXAxis
+                           ? G4ThreeVector(offset, 0.0, layerZ[l])
+                           : G4ThreeVector(0.0, offset, layerZ[l]));
+    pv->SetRotation(rotation);
+}
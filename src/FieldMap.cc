@@ -0,0 +1,98 @@
+#include "FieldMap.hh"
+
+FieldMap::FieldMap() : grid(shared) {
+    if (!grid) throw std::runtime_error("FieldMap: no field map loaded");
+}
+
+// Sorted distinct coordinates of one axis; the spacing must be regular.
+std::vector<G4double> FieldMap::Axis(std::vector<G4double> v, const std::string& name, const std::string& path) {
+    std::sort(v.begin(), v.end());
+    v.erase(std::unique(v.begin(), v.end()), v.end());
+    if (v.size() < 2) throw std::runtime_error("Field map " + path + " needs at least two " + name + " nodes");
+
+    const G4double step = (v.back() - v.front()) / static_cast<G4double>(v.size() - 1);
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        if (std::abs(v[i] - (v.front() + i * step)) > 1e-6 * step) {
+            throw std::runtime_error("Field map " + path + " has an irregular " + name + " grid");
+        }
+    }
+    return v;
+}
+
+void FieldMap::Load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) throw std::runtime_error("Can't open field map: " + path);
+
+    std::vector<G4double> rows;
+    std::string line;
+    std::size_t lineno = 0;
+    while (std::getline(file, line)) {
+        ++lineno;
+        if (const auto hashPos = line.find('#'); hashPos != std::string::npos) line.resize(hashPos);
+        std::istringstream iss(line);
+        G4double r[6];
+        if (!(iss >> r[0])) continue;
+        if (!(iss >> r[1] >> r[2] >> r[3] >> r[4] >> r[5])) {
+            throw std::runtime_error("Bad field map row in " + path + ":" + std::to_string(lineno));
+        }
+        rows.insert(rows.end(), r, r + 6);
+    }
+
+    const std::size_t count = rows.size() / 6;
+    auto g = std::make_shared<Grid>();
+    std::vector<G4double> axes[3];
+    for (G4int k = 0; k < 3; ++k) {
+        std::vector<G4double> c(count);
+        for (std::size_t r = 0; r < count; ++r) c[r] = rows[6 * r + k];
+        axes[k] = Axis(std::move(c), std::string(1, "xyz"[k]), path);
+        g->n[k] = static_cast<G4int>(axes[k].size());
+        g->min[k] = axes[k].front() * mm;
+        g->invStep[k] = (g->n[k] - 1) / ((axes[k].back() - axes[k].front()) * mm);
+    }
+    if (count != static_cast<std::size_t>(g->n[0]) * g->n[1] * g->n[2]) {
+        throw std::runtime_error("Field map " + path + " does not fill its " + std::to_string(g->n[0]) + "x" +
+                                 std::to_string(g->n[1]) + "x" + std::to_string(g->n[2]) + " grid");
+    }
+
+    g->b.assign(3 * count, 0.0);
+    std::vector<bool> filled(count, false);
+    for (std::size_t r = 0; r < count; ++r) {
+        std::size_t node = 0;
+        for (G4int k = 2; k >= 0; --k) {
+            const G4double u = (rows[6 * r + k] * mm - g->min[k]) * g->invStep[k];
+            node = node * g->n[k] + static_cast<std::size_t>(std::lround(u));
+        }
+        if (filled[node]) throw std::runtime_error("Field map " + path + " repeats a node in data row " + std::to_string(r + 1));
+        filled[node] = true;
+        for (G4int c = 0; c < 3; ++c) g->b[3 * node + c] = rows[6 * r + 3 + c] * tesla;
+    }
+
+    shared = std::move(g);
+}
+
+void FieldMap::GetFieldValue(const G4double point[4], G4double* bField) const {
+    bField[0] = bField[1] = bField[2] = 0.0;
+
+    G4int i[3];
+    G4double f[3];
+    for (G4int k = 0; k < 3; ++k) {
+        const G4double u = (point[k] - grid->min[k]) * grid->invStep[k];
+        if (!(u >= 0.0 && u <= grid->n[k] - 1)) return;
+        i[k] = std::min(static_cast<G4int>(u), grid->n[k] - 2);
+        f[k] = u - i[k];
+    }
+
+    // The 8 corners are 4 pairs of neighbouring nodes along x, each pair 6 contiguous values.
+    const std::size_t sy = 3 * static_cast<std::size_t>(grid->n[0]);
+    const std::size_t sz = sy * grid->n[1];
+    const G4double* c = grid->b.data() + 3 * i[0] + sy * i[1] + sz * i[2];
+    for (G4int k = 0; k < 3; ++k) {
+        const G4double c00 = c[k] + f[0] * (c[3 + k] - c[k]);
+        const G4double c10 = c[sy + k] + f[0] * (c[sy + 3 + k] - c[sy + k]);
+        const G4double c01 = c[sz + k] + f[0] * (c[sz + 3 + k] - c[sz + k]);
+        const G4double c11 = c[sz + sy + k] + f[0] * (c[sz + sy + 3 + k] - c[sz + sy + k]);
+        const G4double c0 = c00 + f[1] * (c10 - c00);
+        const G4double c1 = c01 + f[1] * (c11 - c01);
+        bField[k] = c0 + f[2] * (c1 - c0);
+    }
+}
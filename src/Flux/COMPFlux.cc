@@ -10,10 +10,14 @@ COMPFlux::COMPFlux(const G4double cThreshold) {
     Emin = std::max({GetParam(configFile, "E_min", 0.01) * MeV, cThreshold});
     Emax = GetParam(configFile, "E_max", 50.) * MeV;
 
-    BuildCDF();
+    table = SharedTable(TableKey("COMP", alpha, E_Peak, Emin, Emax), [this] { return BuildCDF(); });
 }
 
-void COMPFlux::BuildCDF() {
+FluxTable COMPFlux::BuildCDF() {
+    FluxTable built;
+    auto& energyGrid = built.energy;
+    auto& cdfGrid = built.cdf;
+
     const double k = (2.0 - alpha) / E_Peak;
     if (k <= 0.0) {
         G4Exception("COMPFlux::BuildCDF", "BAD_PARAM",
@@ -57,10 +61,14 @@ void COMPFlux::BuildCDF() {
 
     cdfGrid.front() = 0.0;
     cdfGrid.back() = 1.0;
+    return built;
 }
 
 
 double COMPFlux::SampleEnergy() {
+    const auto& energyGrid = table->energy;
+    const auto& cdfGrid = table->cdf;
+
     double u = G4UniformRand();
 
     const auto it = std::lower_bound(cdfGrid.begin(), cdfGrid.end(), u);
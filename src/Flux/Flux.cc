@@ -11,6 +11,24 @@ ParticleInfo Flux::GenerateParticle() {
     return info;
 }
 
+std::shared_ptr<const FluxTable> Flux::SharedTable(const std::string &key,
+                                                   const std::function<FluxTable()> &build) {
+    std::shared_ptr<TableSlot> slot;
+    {
+        std::lock_guard<std::mutex> lock(tablesMutex);
+        auto &entry = tables[key];
+        if (!entry) entry = std::make_shared<TableSlot>();
+        slot = entry;
+    }
+    std::call_once(slot->built, [&] { slot->table = std::make_shared<const FluxTable>(build()); });
+    return slot->table;
+}
+
+void Flux::ClearTables() {
+    std::lock_guard<std::mutex> lock(tablesMutex);
+    tables.clear();
+}
+
 G4String Flux::Trim(const G4String &_s) {
     const size_t start = _s.find_first_not_of(" \t\r\n");
     if (start == G4String::npos) return "";
@@ -9,12 +9,15 @@ GalacticFlux::GalacticFlux(const G4double cThreshold) {
     Emin = std::max({GetParam(configFile, "E_min", 1.) * MeV, cThreshold});
     Emax = GetParam(configFile, "E_max", 1000000.) * MeV;
 
-    BuildCDF();
+    table = SharedTable(TableKey("Galactic", particle, phiMV, Emin, Emax), [this] { return BuildCDF(); });
 }
 
 
-void GalacticFlux::BuildCDF() {
+FluxTable GalacticFlux::BuildCDF() {
     constexpr G4int NBins = 1000;
+    FluxTable built;
+    auto& energyGrid = built.energy;
+    auto& cdfGrid = built.cdf;
     energyGrid.resize(NBins);
     cdfGrid.resize(NBins);
 
@@ -45,6 +48,7 @@ void GalacticFlux::BuildCDF() {
         cdfGrid[i] /= integral;
     }
     cdfGrid.back() = 1.0;
+    return built;
 }
 
 
@@ -155,6 +159,8 @@ G4double GalacticFlux::J_TOA_GeV(const G4double E) {
 }
 
 G4double GalacticFlux::SampleEnergy() {
+    const auto& energyGrid = table->energy;
+    const auto& cdfGrid = table->cdf;
     const G4double u = G4UniformRand(); // равномерное [0,1)
 
     const auto it = std::lower_bound(cdfGrid.begin(), cdfGrid.end(), u);
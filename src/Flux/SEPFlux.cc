@@ -12,7 +12,7 @@ SEPFlux::SEPFlux(const G4double cThreshold) {
     Emin = std::max({GetParam(configFile, "E_min", 0.1) * MeV, cThreshold});
     Emax = GetParam(configFile, "E_max", 1000.) * MeV;
 
-    BuildCDF();
+    table = SharedTable(TableKey("SEP", path, year, order, Emin, Emax), [this] { return BuildCDF(); });
 }
 
 
@@ -26,9 +26,10 @@ static std::vector<double> ExtractNumbers(const std::string &line) {
 }
 
 
-void SEPFlux::BuildCDF() {
-    EList.clear();
-    CDF.clear();
+FluxTable SEPFlux::BuildCDF() {
+    FluxTable built;
+    auto &EList = built.energy;
+    auto &CDF = built.cdf;
 
     std::ifstream in(path.c_str());
     if (!in) {
@@ -36,7 +37,7 @@ void SEPFlux::BuildCDF() {
                     JustWarning, ("Cannot open " + path).c_str());
         EList = {1. * MeV, 10. * MeV};
         CDF = {0.0, 1.0};
-        return;
+        return built;
     }
 
     std::vector<Row> rows;
@@ -69,7 +70,7 @@ void SEPFlux::BuildCDF() {
                     JustWarning, "No matching rows for given year/order.");
         EList = {1. * MeV, 10. * MeV};
         CDF = {0.0, 1.0};
-        return;
+        return built;
     }
 
     std::sort(rows.begin(), rows.end(),
@@ -140,7 +141,7 @@ void SEPFlux::BuildCDF() {
                     JustWarning, "Energy range too narrow (fewer than 2 points).");
         EList = {1. * MeV, 10. * MeV};
         CDF = {0.0, 1.0};
-        return;
+        return built;
     }
 
     std::vector<double> Es(N), lEs(N), f_sub(N);
@@ -164,15 +165,19 @@ void SEPFlux::BuildCDF() {
 
     if (acc <= 0.0L || !std::isfinite(static_cast<double>(acc))) {
         for (size_t i = 0; i < N; ++i) CDF[i] = static_cast<double>(i) / static_cast<double>(N - 1);
-        return;
+        return built;
     }
 
     for (auto &v: CDF) v /= static_cast<double>(acc);
     CDF.front() = 0.0;
     CDF.back() = 1.0;
+    return built;
 }
 
 G4double SEPFlux::SampleEnergy() {
+    const auto &EList = table->energy;
+    const auto &CDF = table->cdf;
+
     if (EList.size() < 2) return 1.0 * MeV;
 
     const G4double u = G4UniformRand();
@@ -9,7 +9,7 @@ TableFlux::TableFlux(const G4double cThreshold) {
     Emin = std::max({GetParam(configFile, "E_min", 10.) * MeV, cThreshold});
     Emax = GetParam(configFile, "E_max", 100.) * MeV;
 
-    BuildCDF();
+    table = SharedTable(TableKey("Table", path, Emin, Emax), [this] { return BuildCDF(); });
 }
 
 
@@ -22,16 +22,17 @@ inline std::vector<G4double> ExtractNumbers(const std::string &line) {
     return out;
 }
 
-void TableFlux::BuildCDF() {
-    EList.clear();
-    CDF.clear();
+FluxTable TableFlux::BuildCDF() {
+    FluxTable built;
+    auto &EList = built.energy;
+    auto &CDF = built.cdf;
 
     if (path.empty()) {
         G4Exception("TableFlux::BuildCDF", "NO_PATH",
                     JustWarning, "CSV path is empty. Using trivial 2-point spectrum.");
         EList = {1. * MeV, 10. * MeV};
         CDF = {0.0, 1.0};
-        return;
+        return built;
     }
 
     std::ifstream in(path.c_str());
@@ -40,7 +41,7 @@ void TableFlux::BuildCDF() {
                     JustWarning, ("Cannot open " + path + ", using trivial spectrum.").c_str());
         EList = {1. * MeV, 10. * MeV};
         CDF = {0.0, 1.0};
-        return;
+        return built;
     }
 
     std::vector<Row> rows;
@@ -62,7 +63,7 @@ void TableFlux::BuildCDF() {
                     JustWarning, "Not enough data rows (need >=2). Using trivial spectrum.");
         EList = {1. * MeV, 10. * MeV};
         CDF = {0.0, 1.0};
-        return;
+        return built;
     }
 
     std::sort(rows.begin(), rows.end(),
@@ -135,7 +136,7 @@ void TableFlux::BuildCDF() {
                     JustWarning, "Energy range too narrow (fewer than 2 points). Using trivial spectrum.");
         EList = {1. * MeV, 10. * MeV};
         CDF = {0.0, 1.0};
-        return;
+        return built;
     }
 
     lEs.resize(Es.size());
@@ -158,7 +159,7 @@ void TableFlux::BuildCDF() {
         for (size_t i = 0; i < CDF.size(); ++i) {
             CDF[i] = static_cast<G4double>(i) / static_cast<G4double>(CDF.size() - 1);
         }
-        return;
+        return built;
     }
 
     const G4double norm = static_cast<G4double>(acc);
@@ -166,9 +167,13 @@ void TableFlux::BuildCDF() {
 
     CDF.front() = 0.0;
     CDF.back() = 1.0;
+    return built;
 }
 
 G4double TableFlux::SampleEnergy() {
+    const auto &EList = table->energy;
+    const auto &CDF = table->cdf;
+
     if (EList.size() < 2) return 1.0 * MeV;
 
     const G4double u = G4UniformRand();
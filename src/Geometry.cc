@@ -25,9 +25,18 @@ G4VPhysicalVolume* Geometry::Construct() {
                                 nullptr,
                                 false, 0, false);
 
+    delete detector;
     detector = new Detector(worldLV, nist);
     detector->Construct();
 
+    geometryHash = OverlapCheck::GeometryHash(worldPV);
+    if (Configuration::checkOverlaps) {
+        OverlapCheck::Run(worldPV, geometryHash, Configuration::overlapCacheDir);
+    } else if (!OverlapCheck::IsValidated(geometryHash, Configuration::overlapCacheDir)) {
+        G4cout << "Geometry " << geometryHash << " has not been overlap-checked (run once with --check-overlaps)"
+               << G4endl;
+    }
+
     // Sensitive
     trigger1LowerLV = detector->GetTrigger1LowerLV();
     trigger1UpperLV = detector->GetTrigger1UpperLV();
@@ -37,73 +46,172 @@ G4VPhysicalVolume* Geometry::Construct() {
     postCaloACLV    = detector->GetPostCaloACLV();
     coordDetectorLV = detector->GetCoordDetectorLV();
     fiberStripLV    = detector->GetFiberStripLV();
+    crystalLV       = detector->GetCrystalLV();
+
+    DefineRegions();
 
     return worldPV;
 }
 
-void Geometry::ConstructSDandField() {
+/* Named regions for per-region production cuts. Passive covers whatever of the instrument is not
+ * claimed by a detector region. Cuts come from --cuts-config ("<Region> <cut> <unit>", optionally
+ * "<Region>.<gamma|e-|e+|proton>") or later from /run/setCutForRegion; a region without any entry
+ * keeps the physics list default. */
+void Geometry::DefineRegions() const {
+    const std::vector<std::pair<G4String, std::vector<G4LogicalVolume*>>> regions = {
+        {"Passive", {detector->GetInstrumentLV()}},
+        {"Veto", {vetoLV, postCaloACLV}},
+        {"Trigger", {trigger1LowerLV, trigger1UpperLV, trigger2LowerLV, trigger2UpperLV}},
+        {"Fibers", {detector->GetFiberModuleLV()}},
+        {"Calorimeter", {detector->GetCalorimeterArrayLV()}},
+    };
+    const std::vector<G4String> particles = {"gamma", "e-", "e+", "proton"};
+    // Particles a region entry leaves out get the default region's cut, i.e. the physics list default or a
+    // /run/setCut given before the geometry is built.
+    const G4ProductionCuts* defaultCuts = G4ProductionCutsTable::GetProductionCutsTable()->GetDefaultProductionCuts();
+
+    Utils::ConstMap cuts;
+    if (!Configuration::cutsConfig.empty()) {
+        try {
+            cuts = Utils::ReadConstFile(Configuration::cutsConfig);
+        }
+        catch (const std::exception& ex) {
+            G4Exception("Geometry::DefineRegions", "CutsConfig", FatalException, ex.what());
+        }
+    }
+    for (const auto& [key, value] : cuts) {
+        const G4String name = key.substr(0, key.find('.'));
+        const G4String particle = key.find('.') == std::string::npos ? "" : key.substr(key.find('.') + 1);
+        const bool knownRegion = std::any_of(regions.begin(), regions.end(),
+                                             [&](const auto& r) { return r.first == name; });
+        const bool knownParticle = particle.empty()
+            || std::find(particles.begin(), particles.end(), particle) != particles.end();
+        if (!knownRegion || !knownParticle || value <= 0.0) {
+            G4Exception("Geometry::DefineRegions", "CutsConfig", FatalException,
+                        ("Bad production cut entry '" + key + "' in " + Configuration::cutsConfig +
+                            ".\nRegions: Passive, Veto, Trigger, Fibers, Calorimeter").c_str());
+        }
+    }
+
+    auto* store = G4RegionStore::GetInstance();
+    for (const auto& [name, roots] : regions) {
+        G4Region* region = store->FindOrCreateRegion(name);
+        for (auto* lv : roots) {
+            if (lv) region->AddRootLogicalVolume(lv);
+        }
+
+        const auto regionCut = cuts.find(name);
+        const bool configured = std::any_of(cuts.begin(), cuts.end(), [&](const auto& kv) {
+            return kv.first == name || kv.first.rfind(name + ".", 0) == 0;
+        });
+        if (!configured) continue;
+
+        auto* pc = region->GetProductionCuts();
+        if (!pc) {
+            pc = new G4ProductionCuts();
+            region->SetProductionCuts(pc);
+        }
+        for (const auto& particle : particles) {
+            const auto it = cuts.find(name + "." + particle);
+            const G4double cut = it != cuts.end() ? it->second
+                : regionCut != cuts.end() ? regionCut->second : defaultCuts->GetProductionCut(particle);
+            pc->SetProductionCut(cut, particle);
+        }
+    }
+}
+
+// After ReinitializeGeometry the new logical volumes are attached to the detectors registered
+// for the previous geometry instead of registering duplicates.
+G4VSensitiveDetector* Geometry::GetOrCreateSD(const G4String& name, const G4int id, const G4String& detName) {
     auto* sdManager = G4SDManager::GetSDMpointer();
+    if (auto* sd = sdManager->FindSensitiveDetector(name, false)) return sd;
+
+    auto* sd = new SensitiveDetector(name, id, detName);
+    sdManager->AddNewDetector(sd);
+    return sd;
+}
 
+void Geometry::ConstructSDandField() {
     if (trigger1LowerLV) {
-        auto* trigger1LowerSD = new SensitiveDetector("Trigger1LowerSD", 0, "Trigger1Lower");
-        sdManager->AddNewDetector(trigger1LowerSD);
+        auto* trigger1LowerSD = GetOrCreateSD("Trigger1LowerSD", 0, "Trigger1Lower");
         trigger1LowerLV->SetSensitiveDetector(trigger1LowerSD);
     }
 
     if (trigger1UpperLV) {
-        auto* trigger1UpperSD = new SensitiveDetector("Trigger1UpperSD", 1, "Trigger1Upper");
-        sdManager->AddNewDetector(trigger1UpperSD);
+        auto* trigger1UpperSD = GetOrCreateSD("Trigger1UpperSD", 1, "Trigger1Upper");
         trigger1UpperLV->SetSensitiveDetector(trigger1UpperSD);
     }
 
     if (trigger2LowerLV) {
-        auto* trigger2LowerSD = new SensitiveDetector("Trigger2LowerSD", 4, "Trigger2Lower");
-        sdManager->AddNewDetector(trigger2LowerSD);
+        auto* trigger2LowerSD = GetOrCreateSD("Trigger2LowerSD", 4, "Trigger2Lower");
         trigger2LowerLV->SetSensitiveDetector(trigger2LowerSD);
     }
 
     if (trigger2UpperLV) {
-        auto* trigger2UpperSD = new SensitiveDetector("Trigger2UpperSD", 7, "Trigger2Upper");
-        sdManager->AddNewDetector(trigger2UpperSD);
+        auto* trigger2UpperSD = GetOrCreateSD("Trigger2UpperSD", 7, "Trigger2Upper");
         trigger2UpperLV->SetSensitiveDetector(trigger2UpperSD);
     }
 
     if (vetoLV) {
-        auto* vetoSD = new SensitiveDetector("VetoSD", 2, "Veto");
-        sdManager->AddNewDetector(vetoSD);
+        auto* vetoSD = GetOrCreateSD("VetoSD", 2, "Veto");
         vetoLV->SetSensitiveDetector(vetoSD);
     }
 
     if (postCaloACLV) {
-        auto* postCaloACSD = new SensitiveDetector("PostCaloACSD", 9, "PostCaloAC");
-        sdManager->AddNewDetector(postCaloACSD);
+        auto* postCaloACSD = GetOrCreateSD("PostCaloACSD", 9, "PostCaloAC");
         postCaloACLV->SetSensitiveDetector(postCaloACSD);
     }
 
     if (coordDetectorLV) {
-        auto* coordSD = new SensitiveDetector("CoordSD", 3, "TOFFibers");
-        sdManager->AddNewDetector(coordSD);
+        auto* coordSD = GetOrCreateSD("CoordSD", 3, "TOFFibers");
         coordDetectorLV->SetSensitiveDetector(coordSD);
     }
 
     if (fiberStripLV) {
-        auto* fiberSD = new SensitiveDetector("FiberSD", 5, "Fiber");
-        sdManager->AddNewDetector(fiberSD);
+        auto* fiberSD = GetOrCreateSD("FiberSD", 5, "Fiber");
         fiberStripLV->SetSensitiveDetector(fiberSD);
     }
 
-    auto* caloSD = new SensitiveDetector("CalorimeterSD", 6, "Calorimeter");
-    sdManager->AddNewDetector(caloSD);
+    if (crystalLV) {
+        auto* caloSD = GetOrCreateSD("CalorimeterSD", 6, "Calorimeter");
+        crystalLV->SetSensitiveDetector(caloSD);
+    }
 
-    auto* lvStore = G4LogicalVolumeStore::GetInstance();
-    for (G4int ix = 0; ix < Calorimeter::rowsX; ++ix) {
-        for (G4int iy = 0; iy < Calorimeter::rowsY; ++iy) {
-            G4String crystalName = "CsICrystal_" + std::to_string(ix) + "_" + std::to_string(iy) + "LV";
-            G4LogicalVolume* crystalLV = lvStore->GetVolume(crystalName, false);
-            if (crystalLV) {
-                crystalLV->SetSensitiveDetector(caloSD);
-            }
+    AttachField();
+}
+
+/* One field setup per thread, kept across ReinitializeGeometry. With --field-regions the regions are
+ * visited from the outside in (Passive holds the others), each forcing its manager, or none, onto
+ * all of its daughters, so a detector region not listed stays field-free inside a listed Passive. */
+void Geometry::AttachField() const {
+    if (!MagneticField::Enabled()) return;
+
+    static G4ThreadLocal MagneticField* fieldSetup = nullptr;
+    if (!fieldSetup) fieldSetup = new MagneticField();
+    G4FieldManager* fieldManager = fieldSetup->GetFieldManager();
+
+    const auto& selected = Configuration::fieldRegions;
+    if (std::find(selected.begin(), selected.end(), "World") != selected.end()) {
+        worldLV->SetFieldManager(fieldManager, true);
+        return;
+    }
+
+    auto* store = G4RegionStore::GetInstance();
+    for (const auto& name : selected) {
+        if (!store->GetRegion(name, false)) {
+            G4Exception("Geometry::AttachField", "FieldRegions", FatalException,
+                        ("Unknown field region '" + name +
+                            "'.\nRegions: World, Passive, Veto, Trigger, Fibers, Calorimeter").c_str());
         }
     }
 
+    for (const G4String name : {"Passive", "Veto", "Trigger", "Fibers", "Calorimeter"}) {
+        G4Region* region = store->GetRegion(name, false);
+        if (!region) continue;
+        const bool on = std::find(selected.begin(), selected.end(), name) != selected.end();
+        auto lv = region->GetRootLogicalVolumeIterator();
+        for (std::size_t i = 0; i < region->GetNumberOfRootVolumes(); ++i, ++lv) {
+            (*lv)->SetFieldManager(on ? fieldManager : nullptr, true);
+        }
     }
+}
@@ -0,0 +1,89 @@
+#include "InfoFile.hh"
+
+static std::string TrimInfo(std::string s) {
+    auto notSpace = [](const unsigned char c) {
+        return !std::isspace(c);
+    };
+    s.erase(s.begin(), std::find_if(s.begin(), s.end(), notSpace));
+    s.erase(std::find_if(s.rbegin(), s.rend(), notSpace).base(), s.end());
+    return s;
+}
+
+InfoFile::InfoFile(const std::string& p) : path(p) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open info file: " + path);
+    }
+
+    std::string line;
+    std::string lastKey;
+    std::string block;
+    while (std::getline(file, line)) {
+        line = TrimInfo(line);
+        if (line.empty()) continue;
+
+        if (line == "{") {
+            block = lastKey;
+            continue;
+        }
+        if (line == "}") {
+            block.clear();
+            continue;
+        }
+
+        const auto colon = line.find(':');
+        if (colon == std::string::npos) continue;
+
+        std::string key = TrimInfo(line.substr(0, colon));
+        std::string value = TrimInfo(line.substr(colon + 1));
+        if (!value.empty() && value.back() == ',') {
+            value = TrimInfo(value.substr(0, value.size() - 1));
+        }
+
+        lastKey = key;
+        if (!block.empty()) key = block + "." + key;
+
+        if (values.find(key) == values.end()) keys.push_back(key);
+        values[key] = value;
+    }
+}
+
+bool InfoFile::Has(const std::string& key) const {
+    return values.find(key) != values.end();
+}
+
+const std::string& InfoFile::Get(const std::string& key) const {
+    const auto it = values.find(key);
+    if (it == values.end()) {
+        throw std::runtime_error("Key " + key + " not found in " + path);
+    }
+    return it->second;
+}
+
+std::string InfoFile::GetOr(const std::string& key, const std::string& def) const {
+    const auto it = values.find(key);
+    return it == values.end() ? def : it->second;
+}
+
+double InfoFile::GetDouble(const std::string& key) const {
+    try {
+        return std::stod(Get(key));
+    }
+    catch (const std::invalid_argument&) {
+        throw std::runtime_error("Bad numeric value for " + key + " in " + path);
+    }
+}
+
+int InfoFile::GetInt(const std::string& key) const {
+    try {
+        return std::stoi(Get(key));
+    }
+    catch (const std::invalid_argument&) {
+        throw std::runtime_error("Bad integer value for " + key + " in " + path);
+    }
+}
+
+bool InfoFile::GetBool(const std::string& key) const {
+    const std::string& v = Get(key);
+    return v == "1" || v == "true" || v == "yes";
+}
@@ -0,0 +1,297 @@
+#include "JobMerge.hh"
+
+namespace fs = std::filesystem;
+
+JobMerge::JobMerge(std::vector<Input> in) : inputs(std::move(in)) {
+    if (inputs.empty()) throw std::runtime_error("JobMerge: no jobs to merge");
+    for (const auto& job : inputs) infos.emplace_back(job.infoPath);
+
+    // Jobs of one run share everything but the job index.
+    const std::vector<std::string> shared = {
+        "Detector_type", "Geometry_hash", "EM_physics", "Use_optics", "Seed", "Job_count", "Flux_type", "Flux_dir",
+        "Post_processing.E_min", "Post_processing.E_max", "Post_processing.Bins", "Post_processing.Area",
+    };
+    std::set<int> indices;
+    for (const auto& info : infos) {
+        for (const auto& key : shared) {
+            if (info.GetOr(key, "") != infos.front().GetOr(key, "")) {
+                throw std::runtime_error("JobMerge: " + info.Path() + " differs from " + infos.front().Path() +
+                                         " in " + key);
+            }
+        }
+        if (!indices.insert(info.GetInt("Job_index")).second) {
+            throw std::runtime_error("JobMerge: job " + info.Get("Job_index") + " given twice");
+        }
+    }
+
+    const int jobCount = infos.front().GetInt("Job_count");
+    if (static_cast<int>(indices.size()) != jobCount) {
+        std::cerr << "Warning: merging " << indices.size() << " of " << jobCount << " jobs\n";
+    }
+}
+
+// "run_job3.root" -> "run.root", "Uniform_particles:e-_job3" -> "Uniform_particles:e-"
+std::string JobMerge::StripJobTag(const std::string& s) {
+    const std::string tag = "_job";
+    const auto pos = s.rfind(tag);
+    if (pos == std::string::npos) return s;
+    auto end = pos + tag.size();
+    while (end < s.size() && std::isdigit(static_cast<unsigned char>(s[end]))) ++end;
+    if (end == pos + tag.size()) return s;
+    return s.substr(0, pos) + s.substr(end);
+}
+
+// Finds "Key: value" at top level or "Block.Key" inside "Block:\n{ ... }"; returns [begin, end) of the value.
+static std::pair<std::size_t, std::size_t> FindInfoValue(const std::string& text, const std::string& key) {
+    std::size_t from = 0;
+    std::size_t to = text.size();
+    std::string name = key;
+    const bool inBlock = key.find('.') != std::string::npos;
+    if (inBlock) {
+        const std::string header = key.substr(0, key.find('.')) + ":\n{";
+        from = text.find(header);
+        if (from == std::string::npos) return {std::string::npos, std::string::npos};
+        to = text.find("\n}", from);
+        name = key.substr(key.find('.') + 1);
+    }
+
+    for (std::size_t line = from; line < to && line != std::string::npos;) {
+        std::size_t start = line;
+        while (start < to && (text[start] == '\t' || text[start] == ' ')) ++start;
+        const bool indented = start != line;
+        if (indented == inBlock && text.compare(start, name.size() + 1, name + ":") == 0) {
+            std::size_t begin = start + name.size() + 1;
+            while (begin < to && text[begin] == ' ') ++begin;
+            std::size_t end = text.find('\n', begin);
+            if (end == std::string::npos) end = text.size();
+            if (end > begin && text[end - 1] == ',') --end;
+            return {begin, end};
+        }
+        const std::size_t next = text.find('\n', line);
+        line = next == std::string::npos ? next : next + 1;
+    }
+    return {std::string::npos, std::string::npos};
+}
+
+void JobMerge::SetInfoValue(std::string& text, const std::string& key, const std::string& value) {
+    const auto [begin, end] = FindInfoValue(text, key);
+    if (begin == std::string::npos) throw std::runtime_error("JobMerge: no " + key + " entry in the info file");
+    text.replace(begin, end - begin, value);
+}
+
+// Removes a top-level "Key: value" line or a whole "Key:\n{ ... }" block.
+void JobMerge::EraseInfoEntry(std::string& text, const std::string& key) {
+    if (const auto start = text.find(key + ":\n{"); start != std::string::npos) {
+        auto end = text.find("\n}", start);
+        end = end == std::string::npos ? text.size() : end + 2;
+        while (end < text.size() && text[end] == '\n') ++end;
+        text.erase(start, end - start);
+        return;
+    }
+    const auto [begin, end] = FindInfoValue(text, key);
+    if (begin == std::string::npos) return;
+    const std::size_t lineStart = text.rfind('\n', begin) == std::string::npos ? 0 : text.rfind('\n', begin) + 1;
+    std::size_t lineEnd = text.find('\n', end);
+    lineEnd = lineEnd == std::string::npos ? text.size() : lineEnd + 1;
+    while (lineEnd < text.size() && text[lineEnd] == '\n') ++lineEnd;
+    text.erase(lineStart, lineEnd - lineStart);
+}
+
+void JobMerge::MergeRoot(const std::string& outPath) const {
+    TFileMerger merger(false);
+    if (!merger.OutputFile(outPath.c_str(), "RECREATE")) {
+        throw std::runtime_error("JobMerge: cannot create " + outPath);
+    }
+    for (const auto& job : inputs) {
+        std::vector<std::string> files = {job.settings.outputFile};
+        const auto threads = PostProcessing::NtupleFiles(job.settings);
+        files.insert(files.end(), threads.begin(), threads.end());
+        for (const auto& f : files) {
+            if (!merger.AddFile(f.c_str(), false)) throw std::runtime_error("JobMerge: cannot read " + f);
+        }
+    }
+    if (!merger.Merge()) throw std::runtime_error("JobMerge: merging into " + outPath + " failed");
+}
+
+// Summed derived histograms are meaningless; they are refilled as area * N_trig / N_gen per bin,
+// the same way RunAction fills them, and that effective area is returned for the folded rate.
+std::vector<double> JobMerge::RebuildDerived(TFile& file, const std::string& trigName,
+                                             const std::vector<std::string>& derivedNames) const {
+    TH1* gen = nullptr;
+    TH1* trig = nullptr;
+    file.GetObject("genEnergyHist", gen);
+    file.GetObject(trigName.c_str(), trig);
+    if (!gen || !trig) return {};
+
+    const double area = inputs.front().settings.areaCm2;
+    std::vector<double> aEff(gen->GetNbinsX(), 0.0);
+    for (int i = 0; i < gen->GetNbinsX(); ++i) {
+        const double nGen = gen->GetBinContent(i + 1);
+        if (nGen > 0.0) aEff[i] = area * trig->GetBinContent(i + 1) / nGen;
+    }
+
+    for (const auto& name : derivedNames) {
+        TH1* h = nullptr;
+        file.GetObject(name.c_str(), h);
+        if (!h) continue;
+        h->Reset();
+        for (int i = 0; i < h->GetNbinsX(); ++i) h->SetBinContent(i + 1, aEff[i]);
+        h->SetEntries(h->GetNbinsX());
+        h->Write(nullptr, TObject::kOverwrite);
+    }
+    return aEff;
+}
+
+static std::string Fixed(const double v) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(6) << v;
+    return out.str();
+}
+
+static std::string Scientific(const double v) {
+    std::ostringstream out;
+    out << std::scientific << v;
+    return out.str();
+}
+
+void JobMerge::Write(const std::string& mergedInfo) const {
+    const InfoFile& first = infos.front();
+    const PostProcessingSettings& s = inputs.front().settings;
+
+    long long N = 0;
+    RateCounts counts{};
+    RateCounts countsOpt{};
+    RateCounts stored{};
+    bool allStored = true;  // every job was post-processed and has its Stored_counts block
+    std::string jobList;
+    for (const auto& info : infos) {
+        N += std::stoll(info.Get("N"));
+        if (info.GetOr("Stored_counts.Crystal_only", "").empty()) {
+            allStored = false;
+        } else {
+            stored.crystalOnly += info.GetDouble("Stored_counts.Crystal_only");
+            stored.crystalAndVeto += info.GetDouble("Stored_counts.Veto_then_Crystal");
+        }
+        counts.crystalOnly += info.GetDouble("Counts.Crystal_only");
+        counts.crystalAndVeto += info.GetDouble("Counts.Veto_then_Crystal");
+        countsOpt.crystalOnly += info.GetDouble("Optical_Counts.Crystal_only");
+        countsOpt.crystalAndVeto += info.GetDouble("Optical_Counts.Veto_then_Crystal");
+        jobList += (jobList.empty() ? "" : ",") + info.Get("Job_index");
+    }
+
+    const fs::path infoDir = fs::absolute(mergedInfo).parent_path();
+    const std::string rootName = StripJobTag(fs::path(s.outputFile).filename().string());
+    const std::string rootPath = (infoDir / rootName).string();
+    MergeRoot(rootPath);
+
+    std::vector<double> effArea;
+    std::vector<double> effAreaOpt;
+    {
+        std::unique_ptr<TFile> f(TFile::Open(rootPath.c_str(), "UPDATE"));
+        if (!f || f->IsZombie()) throw std::runtime_error("JobMerge: cannot reopen " + rootPath);
+        // Sensitivity only for isotropic fluxes, as in RunAction::FillDerivedHists.
+        std::vector<std::string> derived = {"effAreaHist"};
+        std::vector<std::string> derivedOpt = {"effAreaOptHist"};
+        if (first.GetOr("Flux_dir", "isotropic").find("isotropic") != std::string::npos) {
+            derived.emplace_back("sensitivityHist");
+            derivedOpt.emplace_back("sensitivityOptHist");
+        }
+        effArea = RebuildDerived(*f, "trigEnergyHist", derived);
+        effAreaOpt = RebuildDerived(*f, "trigOptEnergyHist", derivedOpt);
+    }
+
+    const EnergyRange er = s.fluxRange;
+
+    std::string text;
+    {
+        std::ifstream in(first.Path());
+        std::ostringstream ss;
+        ss << in.rdbuf();
+        text = ss.str();
+    }
+
+    SetInfoValue(text, "N", std::to_string(N));
+    SetInfoValue(text, "Job_index", "merged (" + jobList + ")");
+    SetInfoValue(text, "Post_processing.Output_file", rootName);
+    SetInfoValue(text, "Post_processing.Run_folder", StripJobTag(first.Get("Post_processing.Run_folder")));
+    SetInfoValue(text, "Post_processing.Merge_ntuples", "1");
+    if (FindInfoValue(text, "Post_processing.Async_output").first != std::string::npos) {
+        SetInfoValue(text, "Post_processing.Async_output", "0");
+    }
+    SetInfoValue(text, "Counts.Crystal_only", std::to_string(static_cast<long long>(counts.crystalOnly)));
+    SetInfoValue(text, "Counts.Veto_then_Crystal", std::to_string(static_cast<long long>(counts.crystalAndVeto)));
+    SetInfoValue(text, "Optical_Counts.Crystal_only", std::to_string(static_cast<long long>(countsOpt.crystalOnly)));
+    SetInfoValue(text, "Optical_Counts.Veto_then_Crystal",
+                 std::to_string(static_cast<long long>(countsOpt.crystalAndVeto)));
+
+    // Per-job outputs that do not carry over to the merged run.
+    EraseInfoEntry(text, "Threshold_scan");
+    EraseInfoEntry(text, "Bootstrap");
+
+    const auto writeRates = [&](const std::string& block, const RateCounts& c, const std::vector<double>& aEff,
+                                const bool enabled) {
+        const std::string nan = "NaN";
+        RateResult rr{};
+        bool ok = enabled && s.hasFlux;
+        try {
+            if (ok) rr = computeRate(s.fluxType, s.fluxParams, er, s.areaCm2, N, c);
+        }
+        catch (const std::exception&) {
+            ok = false;
+        }
+        SetInfoValue(text, block + ".Area", ok ? Fixed(s.areaCm2) : nan);
+        SetInfoValue(text, block + ".Integral", ok ? Fixed(rr.integral) : nan);
+        SetInfoValue(text, block + ".Integral_error", ok ? Scientific(rr.integralErr) : nan);
+        SetInfoValue(text, block + ".Ndot", ok ? Fixed(rr.Ndot) : nan);
+        SetInfoValue(text, block + ".Rate_Crystal_only", ok ? Fixed(rr.rateCrystal) : nan);
+        SetInfoValue(text, block + ".Rate_Both", ok ? Fixed(rr.rateBoth) : nan);
+
+        RateResult rrReal{};
+        bool realOk = enabled && s.hasFlux && !aEff.empty();
+        try {
+            if (realOk) rrReal = computeRateReal(s.fluxType, s.fluxParams, er, aEff, s.nBins);
+        }
+        catch (const std::exception&) {
+            realOk = false;
+        }
+        SetInfoValue(text, block + ".Rate_Real", realOk ? Fixed(rrReal.rateRealCrystal) : nan);
+        SetInfoValue(text, block + ".Rate_Real_error", realOk ? Scientific(rrReal.rateRealErr) : nan);
+    };
+    writeRates("Rates", counts, effArea, true);
+    writeRates("Optical_rates", countsOpt, effAreaOpt, s.useOptics);
+
+    // The prescale-weighted counts of the jobs add up like the exact ones; a partial sum would be wrong.
+    if (allStored) {
+        std::ostringstream c;
+        c << std::setprecision(17);
+        c << stored.crystalOnly;
+        SetInfoValue(text, "Stored_counts.Crystal_only", c.str());
+        c.str("");
+        c << stored.crystalAndVeto;
+        SetInfoValue(text, "Stored_counts.Veto_then_Crystal", c.str());
+
+        if (FindInfoValue(text, "Stored_counts.Rate_Crystal_only").first != std::string::npos) {
+            std::string rateCrystal = "NaN";
+            std::string rateBoth = "NaN";
+            try {
+                const RateResult rr = computeRate(s.fluxType, s.fluxParams, er, s.areaCm2, N, stored);
+                std::ostringstream r;
+                r << std::setprecision(6) << rr.rateCrystal;
+                rateCrystal = r.str();
+                r.str("");
+                r << rr.rateBoth;
+                rateBoth = r.str();
+            }
+            catch (const std::exception&) {
+            }
+            SetInfoValue(text, "Stored_counts.Rate_Crystal_only", rateCrystal);
+            SetInfoValue(text, "Stored_counts.Rate_Both", rateBoth);
+        }
+    } else {
+        EraseInfoEntry(text, "Stored_counts");
+    }
+
+    std::ofstream out(mergedInfo, std::ios::trunc);
+    if (!out.is_open()) throw std::runtime_error("JobMerge: cannot write " + mergedInfo);
+    out << text;
+}
@@ -2,11 +2,22 @@
 
 using namespace Configuration;
 
+std::vector<G4String> Split(const G4String& line);
+inline std::string Trim(std::string st);
+
+// info_<run>.txt -> <prefix>_<run>.csv
+static std::string ScanFileName(std::string infoName, const std::string& prefix) {
+    if (infoName.rfind("info", 0) == 0) infoName.replace(0, 4, prefix);
+    if (const auto dot = infoName.rfind(".txt"); dot != std::string::npos) infoName.replace(dot, 4, ".csv");
+    return infoName;
+}
+
 Loader::Loader(int argc, char** argv) {
     numThreads = G4Threading::G4GetNumberOfCores();
     useUI = true;
     macroFile = "../run.mac";
-    geomConfigPath = "../geometry_txt";
+    geomConfigPath = "../Geometry_config/geometry.txt";
+    G4bool geomConfigGiven = false;
     detectorType = "CsI";
     fluxType = "Uniform";
     fluxDirection = "isotropic";
@@ -20,6 +31,39 @@ Loader::Loader(int argc, char** argv) {
     nBins = 1000;
     saveSecondaries = false;
     savePhotons = false;
+    mergeNtuples = true;
+    asyncOutput = false;
+    outputQueueDepth = 256;
+    outputBackpressure = "yield";
+    storeTrigger = "all";
+    storePrescale = 1;
+    exportFormat = "csv";
+    bootstrapReplicas = 0;
+    bootstrapSeed = 1;
+    fiberPlacement = "parameterised";
+    benchmark = false;
+    seed = -1;
+    jobIndex = 0;
+    jobCount = 1;
+    replayEvents.clear();
+    runManagerType = "MT";
+    eventModulo = 0;
+    subEventSize = 10000;
+    checkOverlaps = false;
+    overlapCacheDir = "../.overlap_cache";
+    cutsConfig = "";
+    emPhysics = "opt4";
+    physicsCacheDir = "";
+    fieldUniform.clear();
+    fieldMap = "";
+    fieldAccuracy = "standard";
+    fieldRegions = {"World"};
+    thresholdScan = false;
+    scanCrystalThresholds.clear();
+    scanVetoThresholds.clear();
+    scanOptCrystalThresholds.clear();
+    scanOptVetoThresholds.clear();
+    scanOptBottomThresholds.clear();
 
     for (int i = 0; i < argc; i++) {
         if (std::string input(argv[i]); input == "-i" || input == "--input") {
@@ -62,32 +106,274 @@ Loader::Loader(int argc, char** argv) {
             saveSecondaries = true;
         } else if (input == "--save-photons") {
             savePhotons = true;
+        } else if (input == "--no-merge") {
+            mergeNtuples = false;
+        } else if (input == "--async-output") {
+            asyncOutput = true;
+        } else if (input == "--output-queue") {
+            outputQueueDepth = std::stoi(argv[i + 1]);
+        } else if (input == "--output-backpressure") {
+            outputBackpressure = argv[i + 1];
+        } else if (input == "--store-trigger") {
+            storeTrigger = argv[i + 1];
+        } else if (input == "--prescale") {
+            storePrescale = std::stoi(argv[i + 1]);
+        } else if (input == "--export-format") {
+            exportFormat = argv[i + 1];
+        } else if (input == "--bootstrap") {
+            bootstrapReplicas = std::max(0, std::stoi(argv[i + 1]));
+        } else if (input == "--bootstrap-seed") {
+            bootstrapSeed = std::stol(argv[i + 1]);
+        } else if (input == "--fiber-placement") {
+            fiberPlacement = argv[i + 1];
+        } else if (input == "--benchmark") {
+            benchmark = true;
+        } else if (input == "--seed") {
+            seed = std::stol(argv[i + 1]);
+        } else if (input == "--job-index") {
+            jobIndex = std::stoi(argv[i + 1]);
+        } else if (input == "--job-count") {
+            jobCount = std::stoi(argv[i + 1]);
+        } else if (input == "--replay-events") {
+            // "run:event", or just "event" for run 0
+            for (const auto& v : Split(argv[i + 1])) {
+                const auto colon = v.find(':');
+                replayEvents.emplace_back(colon == std::string::npos ? 0 : std::stoi(v.substr(0, colon)),
+                                          std::stoi(colon == std::string::npos ? v : v.substr(colon + 1)));
+            }
+        } else if (input == "--run-manager") {
+            runManagerType = argv[i + 1];
+        } else if (input == "--event-modulo") {
+            eventModulo = std::max(0, std::stoi(argv[i + 1]));
+        } else if (input == "--subevent-size") {
+            subEventSize = std::stoi(argv[i + 1]);
+        } else if (input == "--check-overlaps") {
+            checkOverlaps = true;
+        } else if (input == "--overlap-cache") {
+            overlapCacheDir = argv[i + 1];
+        } else if (input == "--cuts-config") {
+            cutsConfig = argv[i + 1];
+        } else if (input == "--em-physics") {
+            emPhysics = argv[i + 1];
+        } else if (input == "--physics-cache") {
+            physicsCacheDir = argv[i + 1];
+        } else if (input == "--field-uniform") {
+            fieldUniform.clear();
+            for (const auto& v : Split(argv[i + 1])) fieldUniform.push_back(std::stod(v) * tesla);
+        } else if (input == "--field-map") {
+            fieldMap = argv[i + 1];
+        } else if (input == "--field-accuracy") {
+            fieldAccuracy = argv[i + 1];
+        } else if (input == "--field-regions") {
+            fieldRegions.clear();
+            for (const auto& v : Split(argv[i + 1])) fieldRegions.push_back(v);
+        } else if (input == "--scan-crystal") {
+            for (const auto& v : Split(argv[i + 1])) scanCrystalThresholds.push_back(std::stod(v) * MeV);
+        } else if (input == "--scan-veto") {
+            for (const auto& v : Split(argv[i + 1])) scanVetoThresholds.push_back(std::stod(v) * MeV);
+        } else if (input == "--scan-crystal-optic") {
+            for (const auto& v : Split(argv[i + 1])) scanOptCrystalThresholds.push_back(std::stoi(v));
+        } else if (input == "--scan-veto-optic") {
+            for (const auto& v : Split(argv[i + 1])) scanOptVetoThresholds.push_back(std::stoi(v));
+        } else if (input == "--scan-bottom-veto-optic") {
+            for (const auto& v : Split(argv[i + 1])) scanOptBottomThresholds.push_back(std::stoi(v));
         } else if (input == "-g" || input == "--geom-config") {
             geomConfigPath = argv[i + 1];
+            geomConfigGiven = true;
+        } else if (input == "--geom-sweep") {
+            for (const auto& v : Split(argv[i + 1])) geomSweep.push_back(v);
         } else if (input == "-o" || input == "--output-file") {
             outputFile = argv[i + 1];
             outputFile += ".root";
         }
     }
 
+    // Replay: the listed events only, everything recorded.
+    if (!replayEvents.empty()) {
+        saveSecondaries = true;
+        savePhotons = true;
+        storeTrigger = "all";
+        storePrescale = 1;
+        useUI = false;
+    }
     savePhotons = savePhotons and useOptics;
 
+    thresholdScan = !scanCrystalThresholds.empty() || !scanVetoThresholds.empty() ||
+        (useOptics && (!scanOptCrystalThresholds.empty() || !scanOptVetoThresholds.empty() ||
+            !scanOptBottomThresholds.empty()));
+    if (thresholdScan) {
+        if (scanCrystalThresholds.empty()) scanCrystalThresholds = {eCrystalThreshold};
+        if (scanVetoThresholds.empty()) scanVetoThresholds = {eVetoThreshold};
+        if (scanOptCrystalThresholds.empty()) scanOptCrystalThresholds = {oCrystalThreshold};
+        if (scanOptVetoThresholds.empty()) scanOptVetoThresholds = {oVetoThreshold};
+        if (scanOptBottomThresholds.empty()) scanOptBottomThresholds = {oBottomVetoThreshold};
+    }
+
+    if (outputBackpressure != "yield" and outputBackpressure != "sleep") {
+        G4Exception("Loader::Loader", "OutputBackpressure", FatalException,
+                    ("Unknown output backpressure policy: " + outputBackpressure +
+                        ".\nAvailable policies: yield, sleep").c_str());
+    }
+    if (storePrescale < 1) {
+        G4Exception("Loader::Loader", "Prescale", FatalException,
+                    ("Invalid prescale: " + std::to_string(storePrescale) +
+                        ".\nThe prescale must be >= 1; non-triggered events are kept 1 in N").c_str());
+    }
+
+    if (asyncOutput) {
+        // Every worker's writer thread opens its own ROOT file (NtupleWriter).
+        ROOT::EnableThreadSafety();
+    }
+
+    if (exportFormat != "csv" and exportFormat != "binary" and exportFormat != "both") {
+        G4Exception("Loader::Loader", "ExportFormat", FatalException,
+                    ("Unknown export format: " + exportFormat +
+                        ".\nAvailable formats: csv, binary, both").c_str());
+    }
+
+    if (fiberPlacement != "parameterised" and fiberPlacement != "placement") {
+        G4Exception("Loader::Loader", "FiberPlacement", FatalException,
+                    ("Unknown fiber placement: " + fiberPlacement +
+                        ".\nAvailable placements: parameterised, placement").c_str());
+    }
+
+    if (jobCount < 1 || jobIndex < 0 || jobIndex >= jobCount) {
+        G4Exception("Loader::Loader", "JobSplit", FatalException,
+                    ("Bad job split: --job-index " + std::to_string(jobIndex) + " of --job-count " +
+                        std::to_string(jobCount) + ", need 0 <= index < count").c_str());
+    }
+    if (jobCount > 1) {
+        const G4String stem = outputFile.substr(0, outputFile.rfind(".root"));
+        outputFile = stem + "_job" + std::to_string(jobIndex) + ".root";
+    }
+
+    if (!replayEvents.empty()) {
+        if (seed < 0) {
+            G4Exception("Loader::Loader", "Replay", FatalException,
+                        "--replay-events needs the --seed (and --job-index) of the original run, see its info file");
+        }
+        if (!geomSweep.empty()) {
+            G4Exception("Loader::Loader", "Replay", FatalException, "--replay-events cannot be combined with --geom-sweep");
+        }
+        const G4String stem = outputFile.substr(0, outputFile.rfind(".root"));
+        outputFile = stem + "_replay.root";
+    }
+
+    if (runManagerType != "serial" and runManagerType != "MT" and runManagerType != "tasking"
+        and runManagerType != "subevent") {
+        G4Exception("Loader::Loader", "RunManager", FatalException,
+                    ("Unknown run manager: " + runManagerType +
+                        ".\nAvailable run managers: serial, MT, tasking, subevent").c_str());
+    }
+
+    if (runManagerType == "subevent") {
+#ifndef NADYA_SUBEVENT_PARALLEL
+        G4Exception("Loader::Loader", "SubEvent", FatalException,
+                    "--run-manager subevent needs a build with -DNADYA_SUBEVENT_PARALLEL=ON (Geant4 >= 11.2)");
+#endif
+        if (!useOptics) {
+            G4Exception("Loader::Loader", "SubEvent", FatalException,
+                        "--run-manager subevent splits off optical photons and needs --use-optics");
+        }
+        if (subEventSize < 1) {
+            G4Exception("Loader::Loader", "SubEvent", FatalException, "--subevent-size must be >= 1");
+        }
+    }
+
+    if (emPhysics != "opt4" and emPhysics != "regional") {
+        G4Exception("Loader::Loader", "EmPhysics", FatalException,
+                    ("Unknown EM physics mode: " + emPhysics +
+                        ".\nAvailable modes: opt4, regional").c_str());
+    }
+
+    if (!MagneticField::FindPreset(fieldAccuracy)) {
+        G4Exception("Loader::Loader", "FieldAccuracy", FatalException,
+                    ("Unknown field accuracy preset: " + fieldAccuracy +
+                        ".\nAvailable presets: fast, standard, precise").c_str());
+    }
+
+    if (!fieldUniform.empty() && fieldUniform.size() != 3) {
+        G4Exception("Loader::Loader", "FieldUniform", FatalException,
+                    "--field-uniform takes three components: Bx,By,Bz in tesla");
+    }
+
+    if (!fieldUniform.empty() && !fieldMap.empty()) {
+        G4Exception("Loader::Loader", "FieldConfig", FatalException,
+                    "--field-uniform and --field-map are mutually exclusive");
+    }
+
+    if (!fieldMap.empty()) {
+        try {
+            FieldMap::Load(fieldMap);
+        }
+        catch (const std::exception& ex) {
+            G4Exception("Loader::Loader", "FieldMap", FatalException, ex.what());
+        }
+    }
+
     configPath = "../Flux_config/" + fluxType + "_params.txt";
 
-    CLHEP::HepRandom::setTheEngine(new CLHEP::RanecuEngine);
-    CLHEP::HepRandom::setTheSeed(time(nullptr));
+    if (!geomSweep.empty()) {
+        std::set<std::string> tags;
+        for (const auto& g : geomSweep) {
+            if (!tags.insert(SweepTag(g)).second) {
+                G4Exception("Loader::Loader", "GeometrySweep", FatalException,
+                            ("Geometry sweep variants need distinct file names: " + g).c_str());
+            }
+        }
+        geomConfigPath = geomSweep.front();
+        geomConfigGiven = true;
+        useUI = false;
+    }
 
-#ifdef G4MULTITHREADED
-    runManager = new G4MTRunManager;
+    if (geomConfigGiven || std::ifstream(geomConfigPath).good()) {
+        try {
+            Sizes::Load(geomConfigPath);
+        }
+        catch (const std::exception& ex) {
+            G4Exception("Loader::Loader", "GeometryConfig", FatalException, ex.what());
+        }
+    } else {
+        geomConfigPath = "built-in";
+        Sizes::Recompute();
+    }
+
+    if (seed < 0) seed = static_cast<G4long>(std::random_device{}() >> 1);
+    SeedEngine();
+
+    // The *Only types keep G4RUN_MANAGER_TYPE from overriding --run-manager. Without multithreading
+    // support in Geant4 every type falls back to the serial run manager.
+    G4RunManagerType type = runManagerType == "tasking" ? G4RunManagerType::TaskingOnly
+        : runManagerType == "serial" ? G4RunManagerType::SerialOnly : G4RunManagerType::MTOnly;
+#ifdef NADYA_SUBEVENT_PARALLEL
+    if (runManagerType == "subevent") type = G4RunManagerType::SubEvtOnly;
+#endif
+    runManager = G4RunManagerFactory::CreateRunManager(type, nullptr, false);
     runManager->SetNumberOfThreads(numThreads);
-#else
-    runManager = new G4RunManager;
+#ifdef NADYA_SUBEVENT_PARALLEL
+    if (auto* sub = dynamic_cast<G4SubEvtRunManager*>(runManager)) {
+        sub->RegisterSubEventType(0, subEventSize);
+    }
+#endif
+#ifdef G4MULTITHREADED
+    if (auto* mt = dynamic_cast<G4MTRunManager*>(runManager); mt && eventModulo > 0) {
+        mt->SetEventModulo(eventModulo);
+    }
 #endif
 
-    auto* realWorld = new Geometry();
+    realWorld = new Geometry();
     runManager->SetUserInitialization(realWorld);
-    auto* physicsList = new FTFP_BERT;
-    physicsList->ReplacePhysics(new G4EmStandardPhysics_option4());
+    physicsList = new FTFP_BERT;
+    if (emPhysics == "regional") {
+        // Standard option0 everywhere; the option4 model set is activated per region by
+        // G4EmModelActivator when the EM processes are constructed (regions exist by then).
+        physicsList->ReplacePhysics(new G4EmStandardPhysics());
+        auto* em = G4EmParameters::Instance();
+        em->AddPhysics("Calorimeter", "G4EmStandard_opt4");
+        em->AddPhysics("Fibers", "G4EmStandard_opt4");
+    } else {
+        physicsList->ReplacePhysics(new G4EmStandardPhysics_option4());
+    }
     physicsList->ReplacePhysics(new G4RadioactiveDecayPhysics());
 
     if (useOptics) {
@@ -129,19 +415,25 @@ Loader::Loader(int argc, char** argv) {
     } else if (fluxDirection == "horizontal") {
         dir = FluxDir::Horizontal;
     }
-    {
-        const double halfY_mm = static_cast<double>(std::max(Sizes::Envelope::halfX, Sizes::Envelope::halfY));
-        const double sizeZ_mm = static_cast<double>(Sizes::Envelope::sizeZ);
-        const double radius_mm = std::sqrt(halfY_mm * halfY_mm + sizeZ_mm * sizeZ_mm) + 5.0;
-        area = AreaGen_cm2(halfY_mm, sizeZ_mm, radius_mm, radius_mm, dir);
-    }
+    area = GenerationArea();
     runManager->SetUserInitialization(new ActionInitialization(area, EminMeV, EmaxMeV));
     runManager->Initialize();
+    UsePhysicsCache();
 
     visManager = new G4VisExecutive;
     visManager->Initialize();
     G4UImanager* UImanager = G4UImanager::GetUIpointer();
 
+    if (!geomSweep.empty()) {
+        RunGeometrySweep();
+        return;
+    }
+
+    if (!replayEvents.empty()) {
+        ReplayEvents();
+        return;
+    }
+
     if (!useUI) {
         const G4String command = "/control/execute ";
         UImanager->ApplyCommand(command + macroFile);
@@ -152,6 +444,63 @@ Loader::Loader(int argc, char** argv) {
         delete ui;
     }
 
+    CollectResults();
+    // RunPostProcessing();
+}
+
+Loader::~Loader() {
+    delete runManager;
+    delete visManager;
+}
+
+G4double Loader::GenerationArea() const {
+    const double halfY_mm = static_cast<double>(std::max(Sizes::Envelope::halfX, Sizes::Envelope::halfY));
+    const double sizeZ_mm = static_cast<double>(Sizes::Envelope::sizeZ);
+    const double radius_mm = std::sqrt(halfY_mm * halfY_mm + sizeZ_mm * sizeZ_mm) + 5.0;
+    return AreaGen_cm2(halfY_mm, sizeZ_mm, radius_mm, radius_mm, dir);
+}
+
+/* The master engine of job i is seeded from SplitMix64(seed, i). Every event then reseeds its thread's
+ * engine from (seed, job, runID, eventID) in PrimaryGeneratorAction, so events are independent of the thread
+ * and scheduler that ran them, and any event can be rerun alone with --replay-events run:event. */
+void Loader::SeedEngine() const {
+    long seeds[3];
+    Utils::DeriveSeeds(static_cast<std::uint64_t>(seed), static_cast<std::uint64_t>(jobIndex), seeds);
+    CLHEP::HepRandom::setTheEngine(new CLHEP::RanecuEngine);
+    CLHEP::HepRandom::setTheSeeds(seeds);
+}
+
+/* Tables are built on the first BeamOn, after Initialize, so retrieval only has to be requested
+ * here. The key is taken once geometry and regions exist; a cut changed later from a macro makes
+ * Geant4 reject the stored cuts table and build everything as usual. Only the EM tables are cached;
+ * optical and hadronic tables are rebuilt on every run (see PhysicsCache). */
+void Loader::UsePhysicsCache() {
+    if (physicsCacheDir.empty()) return;
+
+    std::ostringstream config;
+    config << "FTFP_BERT;em=" << emPhysics << ";optics=" << useOptics << ";radioactive;steplimiter";
+    physicsCachePath = PhysicsCache::Directory(physicsCacheDir, PhysicsCache::Key(config.str()));
+
+    if (PhysicsCache::IsComplete(physicsCachePath)) {
+        G4cout << "Physics cache: retrieving tables from " << physicsCachePath << G4endl;
+        physicsList->SetPhysicsTableRetrieved(physicsCachePath);
+    } else {
+        G4cout << "Physics cache: no tables in " << physicsCachePath << ", storing after the first run" << G4endl;
+        storePhysicsTables = true;
+    }
+}
+
+void Loader::CollectResults() {
+    geometryHash = realWorld->GetGeometryHash();
+    // Not /run/beamOn of the macro: a macro may hold several, and only the last run is in the output.
+    const G4Run* lastRun = runManager->GetCurrentRun();
+    histories = lastRun ? lastRun->GetNumberOfEvent() : 0;
+
+    if (storePhysicsTables && runManager->GetCurrentRun()) {
+        PhysicsCache::Store(physicsList, physicsCachePath);
+        storePhysicsTables = false;
+    }
+
     const auto* runAction = dynamic_cast<const RunAction*>(runManager->GetUserRunAction());
     if (runAction) {
         const auto& [cOnly, cAndV] = runAction->GetCounts();
@@ -162,14 +511,73 @@ Loader::Loader(int argc, char** argv) {
         crystalOnlyOpt = cOnlyOpt;
         crystalAndVetoOpt = cAndVOpt;
         effAreaOpt = runAction->GetEffAreaOpt();
+        if (const auto* scan = runAction->GetThresholdScan()) {
+            SaveThresholdScan(*scan);
+        }
     }
     SaveConfig();
-    // RunPostProcessing();
 }
 
-Loader::~Loader() {
-    delete runManager;
-    delete visManager;
+/* Runs the macro with its /run/beamOn replaced by one event per replayed (run, event). The counts of a
+ * replay are not a sample of the flux, so no info file is written. */
+void Loader::ReplayEvents() const {
+    std::ifstream macro(macroFile);
+    if (!macro.is_open()) {
+        G4Exception("Loader::ReplayEvents", "FILE_OPEN_FAIL", FatalException, ("Cannot open " + macroFile).c_str());
+    }
+
+    G4UImanager* UImanager = G4UImanager::GetUIpointer();
+    std::string line;
+    while (std::getline(macro, line)) {
+        line = Trim(line);
+        if (line.empty() || line[0] == '#' || line.rfind("/run/beamOn", 0) == 0) continue;
+        UImanager->ApplyCommand(line);
+    }
+    UImanager->ApplyCommand("/run/beamOn " + std::to_string(replayEvents.size()));
+
+    G4cout << "Replayed " << replayEvents.size() << " event(s) into " << outputFile << G4endl;
+}
+
+// Geometry_config/foo.txt -> foo
+std::string Loader::SweepTag(const std::string& path) {
+    return std::filesystem::path(path).stem().string();
+}
+
+/* Runs the macro once per geometry variant in this process. Only the geometry is rebuilt between
+ * variants (ReinitializeGeometry); physics tables, the run manager and the worker threads are
+ * kept, the sensitive detectors are reattached by Geometry::ConstructSDandField. */
+void Loader::RunGeometrySweep() {
+    const G4String baseOutput = outputFile;
+    const G4String stem = baseOutput.substr(0, baseOutput.rfind(".root"));
+    auto* runAction = const_cast<RunAction*>(dynamic_cast<const RunAction*>(runManager->GetUserRunAction()));
+    G4UImanager* UImanager = G4UImanager::GetUIpointer();
+
+    for (std::size_t v = 0; v < geomSweep.size(); ++v) {
+        if (v > 0) {
+            geomConfigPath = geomSweep[v];
+            try {
+                Sizes::Load(geomConfigPath);
+            }
+            catch (const std::exception& ex) {
+                G4Exception("Loader::RunGeometrySweep", "GeometryConfig", FatalException, ex.what());
+            }
+            runManager->ReinitializeGeometry(true);
+            Flux::ClearTables();
+            area = GenerationArea();
+            if (runAction) runAction->SetArea(area);
+        }
+
+        sweepTag = SweepTag(geomConfigPath);
+        outputFile = stem + "_" + sweepTag + ".root";
+        G4cout << "Geometry sweep " << v + 1 << "/" << geomSweep.size() << ": " << geomConfigPath
+               << " -> " << outputFile << G4endl;
+
+        UImanager->ApplyCommand("/control/execute " + macroFile);
+        CollectResults();
+    }
+
+    outputFile = baseOutput;
+    sweepTag.clear();
 }
 
 std::string Loader::ReadValue(const std::string& key, const std::string& filepath = "") const {
@@ -189,6 +597,17 @@ std::string Loader::ReadValue(const std::string& key, const std::string& filepat
     return "";
 }
 
+std::optional<std::string> Loader::FindValue(const std::string& key) const {
+    std::ifstream file(configPath);
+    std::string line;
+    while (file.is_open() && std::getline(file, line)) {
+        if (line.find(key) != std::string::npos) {
+            return line.substr(key.length() + 1);
+        }
+    }
+    return std::nullopt;
+}
+
 
 inline std::string Trim(std::string st) {
     auto notSpace = [](const unsigned char c) {
@@ -213,55 +632,88 @@ std::vector<G4String> Split(const G4String& line) {
 }
 
 
-void Loader::SaveConfig() const {
-    const int N = std::stoi(ReadValue("/run/beamOn", "../run.mac"));
-
-    EnergyRange er{};
-    FluxType fType{};
-    FluxParams fp{};
+void Loader::ReadFlux(FluxType& fType, FluxParams& fp, EnergyRange& er) const {
+    // ReadValue aborts the run on an unreadable config; here a missing entry only has to be reported.
+    auto Require = [this](const std::string& key) {
+        auto value = FindValue(key);
+        if (!value) throw std::runtime_error("Flux config " + configPath + " has no " + key);
+        return *value;
+    };
 
     if (fluxType == "PLAW") {
         fType = FluxType::PLAW;
-        fp.A = std::stod(ReadValue("A:"));
-        fp.alpha = std::stod(ReadValue("alpha:"));
-        fp.E_piv = std::stod(ReadValue("E_Piv:"));
-        er.Emin = std::stod(ReadValue("E_min:"));
-        er.Emax = std::stod(ReadValue("E_max:"));
+        fp.A = std::stod(Require("A:"));
+        fp.alpha = std::stod(Require("alpha:"));
+        fp.E_piv = std::stod(Require("E_Piv:"));
+        er.Emin = std::stod(Require("E_min:"));
+        er.Emax = std::stod(Require("E_max:"));
     } else if (fluxType == "COMP") {
         fType = FluxType::COMP;
-        fp.A = std::stod(ReadValue("A:"));
-        fp.alpha = std::stod(ReadValue("alpha:"));
-        fp.E_piv = std::stod(ReadValue("E_Piv:"));
-        fp.E_peak = std::stod(ReadValue("E_Peak:"));
-        er.Emin = std::stod(ReadValue("E_min:"));
-        er.Emax = std::stod(ReadValue("E_max:"));
+        fp.A = std::stod(Require("A:"));
+        fp.alpha = std::stod(Require("alpha:"));
+        fp.E_piv = std::stod(Require("E_Piv:"));
+        fp.E_peak = std::stod(Require("E_Peak:"));
+        er.Emin = std::stod(Require("E_min:"));
+        er.Emax = std::stod(Require("E_max:"));
     } else if (fluxType == "SEP") {
         fType = FluxType::SEP;
-        fp.sep_year = std::stoi(ReadValue("year:"));
-        fp.sep_order = std::stoi(ReadValue("order:"));
+        fp.sep_year = std::stoi(Require("year:"));
+        fp.sep_order = std::stoi(Require("order:"));
         fp.sep_csv_path = "../SEP_coefficients.CSV";
-        er.Emin = std::stod(ReadValue("E_min:"));
-        er.Emax = std::stod(ReadValue("E_max:"));
+        er.Emin = std::stod(Require("E_min:"));
+        er.Emax = std::stod(Require("E_max:"));
     } else if (fluxType == "Galactic") {
         fType = FluxType::GALACTIC;
-        fp.phiMV = std::stod(ReadValue("phiMV:"));
-        fp.particle = ReadValue("particle:");
-        er.Emin = std::stod(ReadValue("E_min:"));
-        er.Emax = std::stod(ReadValue("E_max:"));
+        fp.phiMV = std::stod(Require("phiMV:"));
+        fp.particle = Require("particle:");
+        er.Emin = std::stod(Require("E_min:"));
+        er.Emax = std::stod(Require("E_max:"));
     } else if (fluxType == "Table") {
         fType = FluxType::TABLE;
-        fp.particle = ReadValue("particle:");
-        fp.table_path = ReadValue("table_path:");
-        er.Emin = std::stod(ReadValue("E_min:"));
-        er.Emax = std::stod(ReadValue("E_max:"));
+        fp.particle = Require("particle:");
+        fp.table_path = Require("table_path:");
+        er.Emin = std::stod(Require("E_min:"));
+        er.Emax = std::stod(Require("E_max:"));
     } else {
         fType = FluxType::UNIFORM;
-        er.Emin = std::stod(ReadValue("E_min:"));
-        er.Emax = std::stod(ReadValue("E_max:"));
+        er.Emin = std::stod(Require("E_min:"));
+        er.Emax = std::stod(Require("E_max:"));
+    }
+}
+
+
+std::string Loader::InfoFileName() const {
+    auto sanitize = [](std::string ss) {
+        for (char& c : ss) if (c == ' ') c = '_';
+        return ss;
+    };
+
+    std::string filename = "info_" + detectorType + "_" + fluxType;
+    if (!sweepTag.empty()) filename += "_geom:" + sweepTag;
+    if (jobCount > 1) filename += "_job" + std::to_string(jobIndex);
+    if (fluxType == "Galactic") {
+        const std::string part = ReadValue("particle:");
+        const std::string phi = ReadValue("phiMV:");
+        filename += "_particle:" + part + "_phiMV:" + phi + ".txt";
+    } else if (fluxType == "Uniform") {
+        const std::string part = ReadValue("particles:");
+        filename += "_particle:" + part + ".txt";
+    } else {
+        filename += ".txt";
     }
+    return sanitize(filename);
+}
+
+void Loader::SaveConfig() const {
+    const G4long N = histories;
 
-    RateCounts counts{crystalOnly, crystalAndVeto};
-    RateCounts countsOpt{crystalOnlyOpt, crystalAndVetoOpt};
+    EnergyRange er{};
+    FluxType fType{};
+    FluxParams fp{};
+    ReadFlux(fType, fp, er);
+
+    RateCounts counts{static_cast<double>(crystalOnly), static_cast<double>(crystalAndVeto)};
+    RateCounts countsOpt{static_cast<double>(crystalOnlyOpt), static_cast<double>(crystalAndVetoOpt)};
 
     RateResult rr{};
     bool rate_ok = true;
@@ -308,8 +760,44 @@ void Loader::SaveConfig() const {
     buf << "N: " << N << "\n\n";
     buf << "Detector_type: " << detectorType << "\n";
     buf << "Crystal_SiPM_configuration: " << crystalSiPMConfig << "\n";
-    buf << "Tyvek_surface: " << (polishedTyvek ? "polished" : "diffuse") << "\n\n";
+    buf << "Tyvek_surface: " << (polishedTyvek ? "polished" : "diffuse") << "\n";
+    buf << "Fiber_placement: " << fiberPlacement << "\n";
+    buf << "Geometry_config: " << geomConfigPath << "\n";
+    buf << "Run_manager: " << runManagerType << " (" << runManager->GetNumberOfThreads() << " threads, event modulo "
+        << (eventModulo > 0 ? std::to_string(eventModulo) : "auto");
+    if (runManagerType == "subevent") buf << ", " << subEventSize << " photons per sub-event";
+    buf << ")\n";
+    buf << "EM_physics: " << emPhysics << "\n";
+    buf << "Cuts_config: " << (cutsConfig.empty() ? "default" : cutsConfig) << "\n";
+    buf << "Magnetic_field: " << MagneticField::Describe() << "\n";
+    buf << "Physics_cache: " << (physicsCachePath.empty() ? "off" : physicsCachePath) << "\n";
+    buf << "Geometry_hash: " << geometryHash << "\n";
+    buf << "Seed: " << seed << "\n";
+    buf << "Job_index: " << jobIndex << "\n";
+    buf << "Job_count: " << jobCount << "\n\n";
     buf << "Use_optics: " << useOptics << "\n\n";
+    buf << "Storage:\n{\n\t";
+    buf << "Trigger: " << storeTrigger << "\n\t";
+    buf << "Prescale: " << storePrescale << "\n}\n\n";
+
+    const PostProcessingSettings ps = PostProcessingConfig();
+    buf << "Post_processing:\n{\n\t";
+    buf << "Output_file: " << ps.outputFile << "\n\t";
+    buf << "Run_folder: " << ps.outputFolderName << "\n\t";
+    buf << "Particle: " << ps.particle << "\n\t";
+    buf << "E_min: " << ps.eMinMeV << "\n\t";
+    buf << "E_max: " << ps.eMaxMeV << "\n\t";
+    buf << "Crystal_threshold: " << ps.eCrystalThresholdMeV << "\n\t";
+    buf << "Bins: " << ps.nBins << "\n\t";
+    buf << "Save_secondaries: " << ps.saveSecondaries << "\n\t";
+    buf << "Save_photons: " << ps.savePhotons << "\n\t";
+    buf << "Merge_ntuples: " << ps.mergeNtuples << "\n\t";
+    buf << "Async_output: " << ps.asyncOutput << "\n\t";
+    buf << "Threads: " << ps.ntupleThreads << "\n\t";
+    buf << "Export_format: " << ps.exportFormat << "\n\t";
+    buf << "Area: " << std::setprecision(17) << ps.areaCm2 << std::setprecision(6) << "\n\t";
+    buf << "Bootstrap: " << ps.bootstrapReplicas << "\n\t";
+    buf << "Bootstrap_seed: " << ps.bootstrapSeed << "\n}\n\n";
     buf << "Flux_type: " << fluxType << "\n";
     buf << "Flux_dir: " << fluxDirection << "\n";
 
@@ -394,25 +882,33 @@ void Loader::SaveConfig() const {
     }
     buf << "}\n\n";
 
+    if (thresholdScan) {
+        buf << "Threshold_scan: " << ScanFileName(InfoFileName(), "threshold_scan") << "\n\n";
+    }
+
     buf << "Rates:\n{\n\t";
     buf << std::fixed << std::setprecision(6);
     if (rate_ok) {
         buf << "Area: " << area << "\n\t";
         buf << "Integral: " << rr.integral << "\n\t";
+        buf << "Integral_error: " << std::scientific << rr.integralErr << std::fixed << "\n\t";
         buf << "Ndot: " << rr.Ndot << "\n\t";
         buf << "Rate_Crystal_only: " << rr.rateCrystal << "\n\t";
         buf << "Rate_Both: " << rr.rateBoth << "\n\t";
     } else {
         buf << "Area: NaN\n\t";
         buf << "Integral: NaN\n\t";
+        buf << "Integral_error: NaN\n\t";
         buf << "Ndot: NaN\n\t";
         buf << "Rate_Crystal_only: NaN\n\t";
         buf << "Rate_Both: NaN\n\t";
     }
     if (rate_real_ok) {
-        buf << "Rate_Real: " << rrReal.rateRealCrystal << "\n";
+        buf << "Rate_Real: " << rrReal.rateRealCrystal << "\n\t";
+        buf << "Rate_Real_error: " << std::scientific << rrReal.rateRealErr << std::fixed << "\n";
     } else {
-        buf << "Rate_Real: NaN\n";
+        buf << "Rate_Real: NaN\n\t";
+        buf << "Rate_Real_error: NaN\n";
     }
     buf << "}\n\n";
 
@@ -421,40 +917,28 @@ void Loader::SaveConfig() const {
     if (rate_opt_ok) {
         buf << "Area: " << area << "\n\t";
         buf << "Integral: " << rr_opt.integral << "\n\t";
+        buf << "Integral_error: " << std::scientific << rr_opt.integralErr << std::fixed << "\n\t";
         buf << "Ndot: " << rr_opt.Ndot << "\n\t";
         buf << "Rate_Crystal_only: " << rr_opt.rateCrystal << "\n\t";
         buf << "Rate_Both: " << rr_opt.rateBoth << "\n\t";
     } else {
         buf << "Area: NaN\n\t";
         buf << "Integral: NaN\n\t";
+        buf << "Integral_error: NaN\n\t";
         buf << "Ndot: NaN\n\t";
         buf << "Rate_Crystal_only: NaN\n\t";
         buf << "Rate_Both: NaN\n\t";
     }
     if (rate_real_opt_ok) {
-        buf << "Rate_Real: " << rrReal_opt.rateRealCrystal << "\n";
+        buf << "Rate_Real: " << rrReal_opt.rateRealCrystal << "\n\t";
+        buf << "Rate_Real_error: " << std::scientific << rrReal_opt.rateRealErr << std::fixed << "\n";
     } else {
-        buf << "Rate_Real: NaN\n";
+        buf << "Rate_Real: NaN\n\t";
+        buf << "Rate_Real_error: NaN\n";
     }
     buf << "}\n\n";
 
-    auto sanitize = [](std::string ss) {
-        for (char& c : ss) if (c == ' ') c = '_';
-        return ss;
-    };
-
-    std::string filename = "info_" + detectorType + "_" + fluxType;
-    if (fluxType == "Galactic") {
-        const std::string part = ReadValue("particle:");
-        const std::string phi = ReadValue("phiMV:");
-        filename += "_particle:" + part + "_phiMV:" + phi + ".txt";
-    } else if (fluxType == "Uniform") {
-        const std::string part = ReadValue("particles:");
-        filename += "_particle:" + part + ".txt";
-    } else {
-        filename += ".txt";
-    }
-    filename = sanitize(filename);
+    const std::string filename = InfoFileName();
 
     std::ofstream out(filename);
     if (!out.is_open()) {
@@ -468,45 +952,169 @@ void Loader::SaveConfig() const {
 }
 
 
-void Loader::RunPostProcessing() const {
+void Loader::SaveThresholdScan(const ThresholdScan& scan) const {
+    const G4long N = histories;
+    const PostProcessingSettings ps = PostProcessingConfig();
+    const auto& cGrid = scan.CrystalGrid();
+    const auto& vGrid = scan.VetoGrid();
+    const int bins = scan.Bins();
+
+    // Ndot and the folding weights do not depend on the thresholds, so they are computed once.
+    double NdotPerHistory = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> w;
+    try {
+        EnergyRange er{};
+        FluxType fType{};
+        FluxParams fp{};
+        ReadFlux(fType, fp, er);
+        if (N > 0) NdotPerHistory = computeRate(fType, fp, er, area, N, {}).Ndot / N;
+        w = foldingWeights(fType, fp, er, bins);
+    }
+    catch (const std::exception&) {
+    }
+
+    const std::string filename = ScanFileName(InfoFileName(), "threshold_scan");
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        G4cerr << "Cannot open " << filename << G4endl;
+        return;
+    }
+    out << "Crystal_threshold_MeV,Veto_threshold_MeV,Crystal_only,Veto_then_Crystal,"
+        << "Rate_Crystal_only,Rate_Both,Rate_Real\n";
+    out << std::setprecision(10);
+    for (size_t iv = 0; iv < vGrid.size(); ++iv) {
+        double rateReal = std::numeric_limits<double>::quiet_NaN();
+        if (static_cast<int>(w.size()) == bins) {
+            rateReal = 0.0;
+            for (int b = 0; b < bins; ++b) rateReal += w[b] * scan.EffArea()[iv * bins + b];
+        }
+        for (size_t ic = 0; ic < cGrid.size(); ++ic) {
+            const double cOnly = scan.CrystalOnly()[ic * vGrid.size() + iv];
+            const double cAndV = scan.CrystalAndVeto()[ic * vGrid.size() + iv];
+            out << cGrid[ic] / MeV << "," << vGrid[iv] / MeV << "," << cOnly << "," << cAndV << ","
+                << cOnly * NdotPerHistory << "," << (cOnly + cAndV) * NdotPerHistory << ","
+                << rateReal << "\n";
+        }
+    }
+    out.close();
+
+    // Effective area per veto threshold (the TOF trigger does not depend on the crystal threshold).
+    if (ps.eMinMeV < ps.eMaxMeV) {
+        const std::string areaName = ScanFileName(InfoFileName(), "threshold_scan_effarea");
+        std::ofstream areaOut(areaName);
+        if (areaOut.is_open()) {
+            areaOut << "E_MeV";
+            for (const double v : vGrid) areaOut << ",Veto_" << v / MeV;
+            areaOut << "\n" << std::setprecision(10);
+            const double ratio = ps.eMaxMeV / ps.eMinMeV;
+            for (int b = 0; b < bins; ++b) {
+                const double e1 = ps.eMinMeV * std::pow(ratio, static_cast<double>(b) / bins);
+                const double e2 = ps.eMinMeV * std::pow(ratio, static_cast<double>(b + 1) / bins);
+                areaOut << std::sqrt(e1 * e2);
+                for (size_t iv = 0; iv < vGrid.size(); ++iv) areaOut << "," << scan.EffArea()[iv * bins + b];
+                areaOut << "\n";
+            }
+        }
+    }
+
+    if (scan.HasOptics()) {
+        const auto& aGrid = scan.OptCrystalGrid();
+        const auto& bGrid = scan.OptVetoGrid();
+        const auto& cGridOpt = scan.OptBottomGrid();
+        const std::string optName = ScanFileName(InfoFileName(), "threshold_scan_optics");
+        std::ofstream optOut(optName);
+        if (optOut.is_open()) {
+            optOut << "Crystal_npe,Veto_npe,BottomVeto_npe,Crystal_only,Veto_then_Crystal,"
+                   << "Rate_Crystal_only,Rate_Both\n";
+            optOut << std::setprecision(10);
+            for (size_t a = 0; a < aGrid.size(); ++a) {
+                for (size_t b = 0; b < bGrid.size(); ++b) {
+                    for (size_t c = 0; c < cGridOpt.size(); ++c) {
+                        const size_t k = (a * bGrid.size() + b) * cGridOpt.size() + c;
+                        const double cOnly = scan.CrystalOnlyOpt()[k];
+                        const double cAndV = scan.CrystalAndVetoOpt()[k];
+                        optOut << aGrid[a] << "," << bGrid[b] << "," << cGridOpt[c] << ","
+                               << cOnly << "," << cAndV << ","
+                               << cOnly * NdotPerHistory << "," << (cOnly + cAndV) * NdotPerHistory << "\n";
+                    }
+                }
+            }
+        }
+    }
+
+    std::cout << "Threshold scan saved in " << filename << std::endl;
+}
+
+
+PostProcessingSettings Loader::PostProcessingConfig() const {
     auto sanitize = [](std::string ss) {
         for (char& c : ss) if (c == ' ') c = '_';
         return ss;
     };
-    std::string part;
 
-    G4double Emin = std::max({std::stod(ReadValue("E_min:")), eCrystalThreshold});
-    G4double Emax = std::stod(ReadValue("E_max:"));
+    PostProcessingSettings ps;
+    ps.outputFile = outputFile;
+    ps.eMinMeV = std::max({std::stod(ReadValue("E_min:")), eCrystalThreshold});
+    ps.eMaxMeV = std::stod(ReadValue("E_max:"));
+    ps.eCrystalThresholdMeV = eCrystalThreshold / MeV;
+    ps.nBins = nBins;
+    ps.useOptics = useOptics;
+    ps.saveSecondaries = saveSecondaries;
+    ps.savePhotons = savePhotons;
+    ps.mergeNtuples = mergeNtuples;
+    ps.asyncOutput = asyncOutput;
+    ps.ntupleThreads = runManager->GetRunManagerType() == G4RunManager::sequentialRM
+                           ? 0 : runManager->GetNumberOfThreads();
+    ps.exportFormat = exportFormat;
+    ps.areaCm2 = area;
+    ps.bootstrapReplicas = bootstrapReplicas;
+    ps.bootstrapSeed = static_cast<std::uint64_t>(bootstrapSeed);
+    ps.infoFile = InfoFileName();
+
+    ps.histories = histories;
+
+    ps.hasFlux = true;
+    try {
+        ReadFlux(ps.fluxType, ps.fluxParams, ps.fluxRange);
+    }
+    catch (const std::exception&) {
+        ps.hasFlux = false;
+    }
+
+    std::string outDir = fluxType;
+    if (fluxType == "Galactic") {
+        const std::string phi = ReadValue("phiMV:");
+        ps.particle = ReadValue("particle:");
+        outDir += "_particle:" + ps.particle + "_phiMV:" + phi;
+    } else if (fluxType == "Uniform") {
+        ps.particle = ReadValue("particles:");
+        outDir += "_particles:" + ps.particle;
+    } else if (fluxType == "PLAW" || fluxType == "COMP") {
+        ps.particle = "gamma";
+    } else if (fluxType == "SEP") {
+        ps.particle = "proton";
+    }
+    if (!sweepTag.empty()) outDir += "_geom:" + sweepTag;
+    if (jobCount > 1) outDir += "_job" + std::to_string(jobIndex);
+    ps.outputFolderName = sanitize(outDir);
+    return ps;
+}
+
+void Loader::RunPostProcessing() const {
+    const PostProcessingSettings ps = PostProcessingConfig();
     try {
         std::cout << "Processing... ";
-        std::string outDir = fluxType;
-        if (fluxType == "Galactic") {
-            const std::string phi = ReadValue("phiMV:");
-            part = ReadValue("particle:");
-            outDir += "_particle:" + part + "_phiMV:" + phi;
-        } else if (fluxType == "Uniform") {
-            part = ReadValue("particles:");
-            outDir += "_particles:" + part;
-        } else if (fluxType == "PLAW" || fluxType == "COMP") {
-            part = "gamma";
-        } else if (fluxType == "SEP") {
-            part = "proton";
-        }
-        outDir = sanitize(outDir);
-        PostProcessing postProcessing(outDir, Emin, Emax, part);
+        if (!ROOT::IsImplicitMTEnabled()) ROOT::EnableImplicitMT();
+        PostProcessing postProcessing(ps);
 
         postProcessing.ExtractNtData();
-        if (Emin < Emax) {
+        if (ps.eMinMeV < ps.eMaxMeV) {
             if (fluxDirection.find("isotropic") != std::string::npos)
                 postProcessing.SaveSensitivity();
             else
                 postProcessing.SaveEffArea();
         }
-        postProcessing.SaveTrigEdepCsv();
-        postProcessing.SaveEdepCsv();
-        if (useOptics) {
-            postProcessing.SaveOpticsCsv();
-        }
+        postProcessing.SaveEventCsvs();
 
         std::cout << "Done!\n";
     }
@@ -1,30 +1,74 @@
 #include "MagneticField.hh"
 
+#include "G4BogackiShampine23.hh"
 #include "G4DormandPrince745.hh"
 
-MagneticField::MagneticField() {
-    const G4ThreeVector B(0., -0.2 * tesla, 0.);
-    const G4double minStep = 0.1 * mm;
+namespace {
+const MagneticField::Preset presets[] = {
+    {"fast", true, 1.0 * mm, 1.0 * mm, 1e-2 * mm, 1e-2 * mm, 1e-5, 1e-3},
+    {"standard", false, 0.1 * mm, 0.1 * mm, 1e-4 * mm, 1e-3 * mm, 5e-5, 1e-3},
+    {"precise", false, 0.01 * mm, 0.01 * mm, 1e-5 * mm, 1e-4 * mm, 1e-7, 1e-5},
+};
+}
+
+const MagneticField::Preset* MagneticField::FindPreset(const G4String& name) {
+    for (const auto& p : presets) {
+        if (name == p.name) return &p;
+    }
+    return nullptr;
+}
+
+G4bool MagneticField::Enabled() {
+    return !Configuration::fieldUniform.empty() || !Configuration::fieldMap.empty();
+}
+
+// "off", "uniform (0, -0.2, 0) T, standard, World" or "map <file>, fast, Fibers+Calorimeter"
+G4String MagneticField::Describe() {
+    if (!Enabled()) return "off";
 
-    const G4double deltaIntersection = 1e-3 * mm;
-    const G4double deltaOneStep = 1e-4 * mm;
-    const G4double deltaChord = 0.1 * mm;
+    std::ostringstream out;
+    if (!Configuration::fieldMap.empty()) {
+        out << "map " << Configuration::fieldMap;
+    } else {
+        const auto& b = Configuration::fieldUniform;
+        out << "uniform (" << b[0] / tesla << ", " << b[1] / tesla << ", " << b[2] / tesla << ") T";
+    }
+    out << ", " << Configuration::fieldAccuracy << ", ";
+    for (std::size_t i = 0; i < Configuration::fieldRegions.size(); ++i) {
+        out << (i ? "+" : "") << Configuration::fieldRegions[i];
+    }
+    return out.str();
+}
+
+MagneticField::MagneticField() {
+    const Preset& preset = *FindPreset(Configuration::fieldAccuracy);
 
-    field = new G4UniformMagField(B);
+    if (!Configuration::fieldMap.empty()) {
+        field = new FieldMap();
+    } else {
+        const auto& b = Configuration::fieldUniform;
+        field = new G4UniformMagField(G4ThreeVector(b[0], b[1], b[2]));
+    }
     fieldManager = new G4FieldManager(field);
 
     equation = new G4Mag_UsualEqRhs(field);
-    stepper = new G4DormandPrince745(equation);
+    if (preset.lowOrderStepper) {
+        stepper = new G4BogackiShampine23(equation);
+    } else {
+        stepper = new G4DormandPrince745(equation);
+    }
 
-    driver = new G4MagInt_Driver(minStep, stepper, stepper->GetNumberOfVariables());
+    driver = new G4MagInt_Driver(preset.minStep, stepper, stepper->GetNumberOfVariables());
 
     chordFinder = new G4ChordFinder(driver);
 
-    fieldManager->SetDeltaIntersection(deltaIntersection);
-    fieldManager->SetDeltaOneStep(deltaOneStep);
+    fieldManager->SetDeltaIntersection(preset.deltaIntersection);
+    fieldManager->SetDeltaOneStep(preset.deltaOneStep);
+    fieldManager->SetMinimumEpsilonStep(preset.epsilonMin);
+    fieldManager->SetMaximumEpsilonStep(preset.epsilonMax);
     fieldManager->SetChordFinder(chordFinder);
 
-    chordFinder->SetDeltaChord(deltaChord);
+    chordFinder->SetDeltaChord(preset.deltaChord);
 }
 
 G4FieldManager* MagneticField::GetFieldManager() const {
@@ -0,0 +1,255 @@
+#include "NtupleWriter.hh"
+
+#include <G4Exception.hh>
+#include <algorithm>
+#include <filesystem>
+
+#include "Configuration.hh"
+
+using namespace Configuration;
+
+NtupleWriter::NtupleWriter(const std::string& path) : file(TFile::Open(path.c_str(), "RECREATE")), job(jobIndex) {
+    if (!file || file->IsZombie()) {
+        G4Exception("NtupleWriter::NtupleWriter", "OutputFile", FatalException,
+                    ("Cannot create ntuple file " + path).c_str());
+        return;
+    }
+
+    edepNT = NewTree("edep", "energy deposition per sensitive channel");
+    AddI(edepNT, "eventID", &eventID);
+    AddI(edepNT, "job", &job);
+    edepName = AddS(edepNT, "det_name");
+    AddD(edepNT, "edep_MeV", &doubles[0]);
+    AddD(edepNT, "weight", &weight);
+
+    fiberHitsNT = NewTree("fiber_hits", "energy deposition per TOF fiber");
+    AddI(fiberHitsNT, "eventID", &eventID);
+    AddI(fiberHitsNT, "job", &job);
+    AddI(fiberHitsNT, "plane", &ints[0]);
+    AddI(fiberHitsNT, "module", &ints[1]);
+    AddI(fiberHitsNT, "layer", &ints[2]);
+    AddI(fiberHitsNT, "fiberIndex", &ints[3]);
+    AddD(fiberHitsNT, "edep_MeV", &doubles[0]);
+    AddD(fiberHitsNT, "weight", &weight);
+
+    crystalHitsNT = NewTree("crystal_hits", "energy deposition per calorimeter crystal");
+    AddI(crystalHitsNT, "eventID", &eventID);
+    AddI(crystalHitsNT, "job", &job);
+    AddI(crystalHitsNT, "ix", &ints[0]);
+    AddI(crystalHitsNT, "iy", &ints[1]);
+    AddI(crystalHitsNT, "channel", &ints[2]);
+    AddD(crystalHitsNT, "edep_MeV", &doubles[0]);
+    AddD(crystalHitsNT, "weight", &weight);
+
+    primaryNT = NewTree("primary", "per-primary particles");
+    AddI(primaryNT, "eventID", &eventID);
+    AddI(primaryNT, "job", &job);
+    primaryName = AddS(primaryNT, "primary_name");
+    AddD(primaryNT, "E_MeV", &doubles[0]);
+    AddD(primaryNT, "dir_x", &doubles[1]);
+    AddD(primaryNT, "dir_y", &doubles[2]);
+    AddD(primaryNT, "dir_z", &doubles[3]);
+    AddD(primaryNT, "pos_x_mm", &doubles[4]);
+    AddD(primaryNT, "pos_y_mm", &doubles[5]);
+    AddD(primaryNT, "pos_z_mm", &doubles[6]);
+    AddD(primaryNT, "weight", &weight);
+    AddI(primaryNT, "seed1", &ints[0]);
+    AddI(primaryNT, "seed2", &ints[1]);
+
+    if (saveSecondaries) {
+        interactionsNT = NewTree("interactions", "inelastic/compton/photo/conv vertices and secondaries");
+        AddI(interactionsNT, "eventID", &eventID);
+        AddI(interactionsNT, "job", &job);
+        AddI(interactionsNT, "trackID", &ints[0]);
+        AddI(interactionsNT, "parentID", &ints[1]);
+        processName = AddS(interactionsNT, "process");
+        volumeName = AddS(interactionsNT, "volume_name");
+        AddI(interactionsNT, "volume_id", &ints[3]);
+        AddD(interactionsNT, "x_mm", &doubles[0]);
+        AddD(interactionsNT, "y_mm", &doubles[1]);
+        AddD(interactionsNT, "z_mm", &doubles[2]);
+        AddD(interactionsNT, "t_ns", &doubles[3]);
+        AddI(interactionsNT, "sec_index", &ints[2]);
+        secName = AddS(interactionsNT, "sec_name");
+        AddD(interactionsNT, "sec_E_MeV", &doubles[4]);
+        AddD(interactionsNT, "sec_dir_x", &doubles[5]);
+        AddD(interactionsNT, "sec_dir_y", &doubles[6]);
+        AddD(interactionsNT, "sec_dir_z", &doubles[7]);
+        AddD(interactionsNT, "weight", &weight);
+
+        eventNT = NewTree("event", "per-event summary");
+        AddI(eventNT, "eventID", &eventID);
+        AddI(eventNT, "job", &job);
+        AddI(eventNT, "n_primaries", &ints[0]);
+        AddI(eventNT, "n_interactions", &ints[1]);
+        AddI(eventNT, "n_edep_hits", &ints[2]);
+        AddD(eventNT, "weight", &weight);
+    }
+
+    if (useOptics) {
+        SiPMEventNT = NewTree("sipm_event", "SiPM p.e. per event");
+        AddI(SiPMEventNT, "eventID", &eventID);
+        AddI(SiPMEventNT, "job", &job);
+        AddI(SiPMEventNT, "npe_crystal", &ints[0]);
+        AddI(SiPMEventNT, "npe_veto", &ints[1]);
+        AddI(SiPMEventNT, "npe_bottom_veto", &ints[2]);
+        AddD(SiPMEventNT, "weight", &weight);
+
+        SiPMChannelNT = NewTree("sipm_ch", "SiPM p.e. per channel");
+        AddI(SiPMChannelNT, "eventID", &eventID);
+        AddI(SiPMChannelNT, "job", &job);
+        subdetName = AddS(SiPMChannelNT, "subdet");
+        AddI(SiPMChannelNT, "ch", &ints[0]);
+        AddI(SiPMChannelNT, "npe", &ints[1]);
+        AddD(SiPMChannelNT, "weight", &weight);
+
+        if (savePhotons) {
+            photonsCountNT = NewTree("photons_count", "generated photon count in volumes");
+            AddI(photonsCountNT, "eventID", &eventID);
+            AddI(photonsCountNT, "job", &job);
+            AddI(photonsCountNT, "npe_crystal", &ints[0]);
+            AddI(photonsCountNT, "npe_veto", &ints[1]);
+            AddI(photonsCountNT, "npe_bottom_veto", &ints[2]);
+            AddD(photonsCountNT, "weight", &weight);
+
+            photonsNT = NewTree("photons", "photon register information");
+            AddI(photonsNT, "eventID", &eventID);
+            AddI(photonsNT, "job", &job);
+            AddI(photonsNT, "photonID", &ints[0]);
+            photonDetName = AddS(photonsNT, "det_name");
+            AddI(photonsNT, "det_ch", &ints[1]);
+            AddD(photonsNT, "energy", &doubles[0]);
+            AddD(photonsNT, "pos_x", &doubles[1]);
+            AddD(photonsNT, "pos_y", &doubles[2]);
+            AddD(photonsNT, "pos_z", &doubles[3]);
+            AddD(photonsNT, "weight", &weight);
+        }
+    }
+}
+
+NtupleWriter::~NtupleWriter() {
+    Close();
+}
+
+std::string NtupleWriter::PathFor(const std::string& rootPath, const int thread) {
+    const std::filesystem::path p(rootPath);
+    return (p.parent_path() / (p.stem().string() + "_w" + std::to_string(thread) + p.extension().string()))
+        .string();
+}
+
+TTree* NtupleWriter::NewTree(const char* name, const char* title) {
+    auto* tree = new TTree(name, title);
+    tree->SetDirectory(file.get());
+    return tree;
+}
+
+void NtupleWriter::AddI(TTree* tree, const char* column, Int_t* address) {
+    tree->Branch(column, address, (std::string(column) + "/I").c_str());
+}
+
+void NtupleWriter::AddD(TTree* tree, const char* column, Double_t* address) {
+    tree->Branch(column, address, (std::string(column) + "/D").c_str());
+}
+
+TBranch* NtupleWriter::AddS(TTree* tree, const char* column) {
+    static char empty[1] = "";
+    return tree->Branch(column, empty, (std::string(column) + "/C").c_str());
+}
+
+void NtupleWriter::Point(TBranch* branch, const G4String& value) {
+    branch->SetAddress(const_cast<char*>(value.c_str()));
+}
+
+// Same row order as AnalysisManager::WriteRecord; rows of trees that were not booked are skipped, as
+// G4AnalysisManager skips them.
+void NtupleWriter::Write(const EventRecord& rec) {
+    eventID = rec.eventID;
+    weight = rec.weight;
+
+    for (const auto& p : rec.primaries) {
+        Point(primaryName, p.name);
+        doubles[0] = p.E_MeV;
+        std::copy_n(p.dir, 3, doubles + 1);
+        std::copy_n(p.pos_mm, 3, doubles + 4);
+        ints[0] = p.seeds[0];
+        ints[1] = p.seeds[1];
+        primaryNT->Fill();
+    }
+
+    for (const auto& r : rec.interactions) {
+        if (!interactionsNT) break;
+        ints[0] = r.trackID;
+        ints[1] = r.parentID;
+        Point(processName, r.process);
+        Point(volumeName, r.volumeName);
+        ints[3] = r.volumeID;
+        std::copy_n(r.pos_mm, 3, doubles);
+        doubles[3] = r.t_ns;
+        ints[2] = r.secIndex;
+        Point(secName, r.secName);
+        doubles[4] = r.secE_MeV;
+        std::copy_n(r.secDir, 3, doubles + 5);
+        interactionsNT->Fill();
+    }
+
+    for (const auto& ph : rec.photons) {
+        if (!photonsNT) break;
+        ints[0] = ph.photonID;
+        Point(photonDetName, ph.detName);
+        ints[1] = ph.detCh;
+        doubles[0] = ph.energy_eV;
+        std::copy_n(ph.pos_mm, 3, doubles + 1);
+        photonsNT->Fill();
+    }
+    if (rec.hasPhotonCount && photonsCountNT) {
+        std::copy_n(rec.photonCount, 3, ints);
+        photonsCountNT->Fill();
+    }
+
+    for (const auto& f : rec.fiberHits) {
+        ints[0] = f.plane;
+        ints[1] = f.module;
+        ints[2] = f.layer;
+        ints[3] = f.fiberIndex;
+        doubles[0] = f.edep_MeV;
+        fiberHitsNT->Fill();
+    }
+    for (const auto& c : rec.crystalHits) {
+        ints[0] = c.ix;
+        ints[1] = c.iy;
+        ints[2] = c.channel;
+        doubles[0] = c.edep_MeV;
+        crystalHitsNT->Fill();
+    }
+    for (const auto& e : rec.edeps) {
+        Point(edepName, e.detName);
+        doubles[0] = e.edep_MeV;
+        edepNT->Fill();
+    }
+
+    if (rec.hasEventRow && eventNT) {
+        ints[0] = rec.nPrimaries;
+        ints[1] = rec.nInteractions;
+        ints[2] = rec.nEdepHits;
+        eventNT->Fill();
+    }
+
+    if (rec.hasSiPMEvent && SiPMEventNT) {
+        std::copy_n(rec.npe, 3, ints);
+        SiPMEventNT->Fill();
+    }
+    for (const auto& c : rec.sipmChannels) {
+        if (!SiPMChannelNT) break;
+        Point(subdetName, c.subdet);
+        ints[0] = c.ch;
+        ints[1] = c.npe;
+        SiPMChannelNT->Fill();
+    }
+}
+
+void NtupleWriter::Close() {
+    if (!file) return;
+    file->Write();
+    file->Close();
+    file.reset();
+}
@@ -0,0 +1,58 @@
+#include "OutputQueue.hh"
+
+OutputQueue::OutputQueue(const std::size_t capacity, const Backpressure p)
+    : slots(std::max<std::size_t>(1, capacity)), policy(p) {}
+
+OutputQueue::~OutputQueue() {
+    Stop();
+}
+
+void OutputQueue::Start(const std::string& path) {
+    if (writer.joinable()) return;
+    // Opened here so a failure is reported on the Geant4 thread; from now on only the writer uses it.
+    sink = std::make_unique<NtupleWriter>(path);
+    stopping.store(false, std::memory_order_release);
+    writer = std::thread(&OutputQueue::Drain, this);
+}
+
+void OutputQueue::Stop() {
+    if (!writer.joinable()) return;
+    stopping.store(true, std::memory_order_release);
+    writer.join();
+    sink.reset();
+}
+
+void OutputQueue::WaitOnFull() const {
+    if (policy == Backpressure::Sleep) {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    } else {
+        std::this_thread::yield();
+    }
+}
+
+void OutputQueue::Push(EventRecord& rec) {
+    const std::size_t h = head.load(std::memory_order_relaxed);
+    while (h - tail.load(std::memory_order_acquire) >= slots.size()) {
+        WaitOnFull();
+    }
+    std::swap(slots[h % slots.size()], rec);
+    head.store(h + 1, std::memory_order_release);
+    rec.Clear();
+}
+
+void OutputQueue::Drain() {
+    for (;;) {
+        const std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            if (stopping.load(std::memory_order_acquire) && t == head.load(std::memory_order_acquire)) {
+                sink->Close();
+                return;
+            }
+            // Idle writer never spins: it would steal a core from the simulation threads.
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            continue;
+        }
+        sink->Write(slots[t % slots.size()]);
+        tail.store(t + 1, std::memory_order_release);
+    }
+}
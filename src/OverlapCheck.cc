@@ -0,0 +1,83 @@
+#include "OverlapCheck.hh"
+
+namespace fs = std::filesystem;
+
+static void WriteTransform(std::ostringstream& out, const G4VPhysicalVolume* pv) {
+    const G4ThreeVector t = pv->GetTranslation();
+    out << " t " << t.x() << " " << t.y() << " " << t.z();
+    if (const G4RotationMatrix* r = pv->GetRotation()) {
+        out << " r " << r->xx() << " " << r->xy() << " " << r->xz()
+            << " " << r->yx() << " " << r->yy() << " " << r->yz()
+            << " " << r->zx() << " " << r->zy() << " " << r->zz();
+    }
+}
+
+void OverlapCheck::Describe(const G4LogicalVolume* lv, std::ostringstream& out,
+                            std::set<const G4LogicalVolume*>& seen) {
+    if (!seen.insert(lv).second) return;
+
+    out << "LV " << lv->GetName() << " " << lv->GetMaterial()->GetName() << "\n";
+    lv->GetSolid()->StreamInfo(out);
+
+    for (std::size_t i = 0; i < lv->GetNoDaughters(); ++i) {
+        G4VPhysicalVolume* pv = lv->GetDaughter(i);
+        out << "PV " << pv->GetName() << " -> " << pv->GetLogicalVolume()->GetName()
+            << " copy " << pv->GetCopyNo() << " n " << pv->GetMultiplicity();
+
+        if (G4VPVParameterisation* param = pv->GetParameterisation()) {
+            for (G4int c = 0; c < pv->GetMultiplicity(); ++c) {
+                param->ComputeTransformation(c, pv);
+                WriteTransform(out, pv);
+            }
+        } else {
+            WriteTransform(out, pv);
+        }
+        out << "\n";
+    }
+
+    for (std::size_t i = 0; i < lv->GetNoDaughters(); ++i) {
+        Describe(lv->GetDaughter(i)->GetLogicalVolume(), out, seen);
+    }
+}
+
+std::string OverlapCheck::GeometryHash(G4VPhysicalVolume* world) {
+    std::ostringstream out;
+    out << std::setprecision(12);
+    std::set<const G4LogicalVolume*> seen;
+    Describe(world->GetLogicalVolume(), out, seen);
+
+    return Utils::HashHex(out.str());
+}
+
+bool OverlapCheck::IsValidated(const std::string& hash, const std::string& cacheDir) {
+    return fs::exists(fs::path(cacheDir) / (hash + ".pass"));
+}
+
+bool OverlapCheck::Run(G4VPhysicalVolume* world, const std::string& hash, const std::string& cacheDir,
+                       const G4int resolution) {
+    if (IsValidated(hash, cacheDir)) {
+        G4cout << "Overlap check: geometry " << hash << " already validated" << G4endl;
+        return true;
+    }
+
+    G4cout << "Overlap check: geometry " << hash << G4endl;
+    G4int failed = 0;
+    for (auto* pv : *G4PhysicalVolumeStore::GetInstance()) {
+        if (pv == world || !pv->GetMotherLogical()) continue;
+        if (pv->CheckOverlaps(resolution, 0.0, false, 1)) {
+            G4cout << "  overlap: " << pv->GetName() << G4endl;
+            ++failed;
+        }
+    }
+
+    if (failed > 0) {
+        G4cout << "Overlap check: " << failed << " volume(s) overlap; result not cached" << G4endl;
+        return false;
+    }
+
+    std::error_code ec;
+    fs::create_directories(cacheDir, ec);
+    std::ofstream(fs::path(cacheDir) / (hash + ".pass")) << "resolution " << resolution << "\n";
+    G4cout << "Overlap check: passed, cached in " << cacheDir << G4endl;
+    return true;
+}
@@ -0,0 +1,61 @@
+#include "PhysicsCache.hh"
+
+namespace fs = std::filesystem;
+
+static const char* kCompleteMarker = "complete";
+
+std::string PhysicsCache::Key(const std::string& physicsConfig) {
+    std::ostringstream out;
+    out.precision(17);
+    out << physicsConfig << "\nG4 " << G4VERSION_NUMBER << "\n";
+
+    for (const G4Material* m : *G4Material::GetMaterialTable()) {
+        out << "M " << m->GetName() << " " << m->GetDensity() << " " << m->GetState()
+            << " " << m->GetTemperature() << " " << m->GetPressure()
+            << " " << m->GetIonisation()->GetMeanExcitationEnergy();
+        const G4double* fractions = m->GetFractionVector();
+        for (std::size_t i = 0; i < m->GetNumberOfElements(); ++i) {
+            const G4Element* el = m->GetElement(static_cast<G4int>(i));
+            out << " " << el->GetName() << ":" << el->GetZ() << ":" << el->GetN() << ":" << fractions[i];
+        }
+        out << "\n";
+    }
+
+    for (const G4Region* r : *G4RegionStore::GetInstance()) {
+        out << "R " << r->GetName();
+        if (const G4ProductionCuts* cuts = r->GetProductionCuts()) {
+            for (const G4double c : cuts->GetProductionCuts()) out << " " << c;
+        }
+        out << "\n";
+    }
+
+    return Utils::HashHex(out.str());
+}
+
+std::string PhysicsCache::Directory(const std::string& cacheDir, const std::string& key) {
+    return (fs::path(cacheDir) / key).string();
+}
+
+bool PhysicsCache::IsComplete(const std::string& dir) {
+    std::error_code ec;
+    return fs::exists(fs::path(dir) / kCompleteMarker, ec);
+}
+
+bool PhysicsCache::Store(G4VUserPhysicsList* physicsList, const std::string& dir) {
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec) {
+        G4cout << "Physics cache: cannot create " << dir << " (" << ec.message() << ")" << G4endl;
+        return false;
+    }
+
+    if (!physicsList->StorePhysicsTable(dir)) {
+        G4cout << "Physics cache: storing tables in " << dir << " failed; not marked complete" << G4endl;
+        return false;
+    }
+
+    // Written last, so an interrupted store is never picked up by a later run.
+    std::ofstream(fs::path(dir) / kCompleteMarker) << "G4 " << G4VERSION_NUMBER << "\n";
+    G4cout << "Physics cache: tables stored in " << dir << G4endl;
+    return true;
+}
@@ -1,16 +1,10 @@
 #include "PostProcessing.hh"
 
 namespace fs = std::filesystem;
-using namespace Configuration;
-
-PostProcessing::PostProcessing(std::string outputFolderName,
-                               double eMinMeV,
-                               double eMaxMeV,
-                               std::string particle) : outputFolderName(std::move(outputFolderName)),
-                                                       eMinMeV(eMinMeV),
-                                                       eMaxMeV(eMaxMeV),
-                                                       particleName(std::move(particle)) {
-    ROOT::EnableImplicitMT();
+
+PostProcessing::PostProcessing(PostProcessingSettings settings) : settings(std::move(settings)) {
+    // Implicit MT is process-wide and sized once by the caller (NADYAPost main, Loader::RunPostProcessing).
+    ROOT::EnableThreadSafety();
     gROOT->SetBatch(kTRUE);
 
     gErrorIgnoreLevel = kWarning;
@@ -22,22 +16,78 @@ PostProcessing::PostProcessing(std::string outputFolderName,
 PostProcessing::~PostProcessing() = default;
 
 void PostProcessing::OpenRootFile() {
-    rootFile.reset(TFile::Open(outputFile.c_str(), "READ"));
+    rootFile.reset(TFile::Open(settings.outputFile.c_str(), "READ"));
     if (!rootFile || rootFile->IsZombie()) {
-        throw std::runtime_error("Failed to open ROOT file: " + outputFile);
+        throw std::runtime_error("Failed to open ROOT file: " + settings.outputFile);
+    }
+
+    ntupleFiles = NtupleFiles(settings);
+    for (const auto& path : ntupleFiles) {
+        if (!fs::exists(path)) throw std::runtime_error("Missing per-thread ntuple file: " + path);
+    }
+    if (ntupleFiles.empty()) {
+        ntupleFiles.push_back(settings.outputFile);
     }
 }
 
-void PostProcessing::PrepareOutputDirs() {
-    fs::path rootPath(outputFile.data());
-    fs::path rootDir = rootPath.parent_path();
+std::vector<std::string> PostProcessing::ThreadFiles(const std::string& rootPath, const int nThreads,
+                                                     const char* tag) {
+    const fs::path p(rootPath);
+    std::vector<std::string> files;
+    files.reserve(std::max(0, nThreads));
+    for (int t = 0; t < nThreads; ++t) {
+        files.push_back((p.parent_path() / (p.stem().string() + tag + std::to_string(t) + p.extension().string()))
+            .string());
+    }
+    return files;
+}
+
+std::vector<std::string> PostProcessing::NtupleFiles(const PostProcessingSettings& s) {
+    // A sequential run with --async-output still has one writer, _w0.
+    if (s.asyncOutput) return ThreadFiles(s.outputFile, std::max(1, s.ntupleThreads), "_w");
+    if (!s.mergeNtuples) return ThreadFiles(s.outputFile, s.ntupleThreads);
+    return {};
+}
 
-    postProcessingDir = (rootDir / "post_processing").string();
-    runDir = (fs::path(postProcessingDir) / outputFolderName).string();
+std::unique_ptr<TChain> PostProcessing::MakeChain(const std::string& treeName) const {
+    auto chain = std::make_unique<TChain>(treeName.c_str());
+    for (const auto& path : ntupleFiles) {
+        std::unique_ptr<TFile> f(TFile::Open(path.c_str(), "READ"));
+        if (!f || f->IsZombie()) continue;
+
+        TTree* t = nullptr;
+        f->GetObject(treeName.c_str(), t);
+        if (t) {
+            chain->Add(path.c_str(), t->GetEntries());
+        }
+    }
+    if (chain->GetNtrees() == 0) {
+        return nullptr;
+    }
+    chain->LoadTree(0);
+    return chain;
+}
+
+void PostProcessing::BindWeight(TTree* tree, double* weight) {
+    *weight = 1.0;
+    if (!tree->GetBranch("weight")) return;
+    tree->SetBranchStatus("weight", true);
+    tree->SetBranchAddress("weight", weight);
+}
+
+std::string PostProcessing::RunDirFor(const PostProcessingSettings& s) {
+    const fs::path rootDir = fs::path(s.outputFile).parent_path();
+    return (rootDir / "post_processing" / s.outputFolderName).string();
+}
+
+void PostProcessing::PrepareOutputDirs() {
+    runDir = RunDirFor(settings);
+    postProcessingDir = fs::path(runDir).parent_path().string();
 
     effectiveAreaDir = (fs::path(runDir) / "effective_area").string();
     sensitivityDir = (fs::path(runDir) / "sensitivity").string();
     csvDir = (fs::path(runDir) / "CSV").string();
+    columnarDir = (fs::path(runDir) / "Columnar").string();
     histogramsDir = (fs::path(runDir) / "Histograms").string();
 
 
@@ -86,12 +136,16 @@ void PostProcessing::SaveHistPng(const std::string& histName,
                                  const std::string& yTitle,
                                  const bool filled,
                                  const bool useTrig) {
+    // ROOT graphics is not thread-safe; NADYAPost runs several PostProcessing instances at once.
+    static std::mutex canvasMutex;
+    std::lock_guard lock(canvasMutex);
+
     TH1* h = GetHistOrThrow(histName);
 
     TCanvas canvas("canvas", "canvas", 1920, 1080);
     canvas.SetLogx(true);
 
-    const short color = GetColorForParticle(particleName);
+    const short color = GetColorForParticle(settings.particle);
 
     h->SetTitle(plotTitle.c_str());
     h->GetXaxis()->SetTitle("Energy");
@@ -100,10 +154,10 @@ void PostProcessing::SaveHistPng(const std::string& histName,
     // h->GetXaxis()->SetMoreLogLabels(true);
     // h->GetXaxis()->SetNoExponent(true);
 
-    if (eMinMeV > eCrystalThreshold && eMaxMeV > eMinMeV) {
-        h->GetXaxis()->SetRangeUser(eMinMeV, eMaxMeV);
+    if (settings.eMinMeV > settings.eCrystalThresholdMeV && settings.eMaxMeV > settings.eMinMeV) {
+        h->GetXaxis()->SetRangeUser(settings.eMinMeV, settings.eMaxMeV);
     } else {
-        h->GetXaxis()->SetRangeUser(eCrystalThreshold, eMaxMeV);
+        h->GetXaxis()->SetRangeUser(settings.eCrystalThresholdMeV, settings.eMaxMeV);
     }
 
     h->SetLineColor(color);
@@ -124,108 +178,205 @@ void PostProcessing::SaveHistPng(const std::string& histName,
 }
 
 
-void PostProcessing::ExportTreeToCsv(const std::string& treeName,
-                                     const std::string& csvPath) {
-    TTree* tree = nullptr;
-    rootFile->GetObject(treeName.c_str(), tree);
-    if (!tree) {
-        throw std::runtime_error("TTree/NTuple not found: " + treeName);
+namespace {
+    constexpr Long64_t kCsvChunkRows = 32768;
+
+    struct CsvColumn {
+        TreeColumns::Type type;
+        int width;
+    };
+
+    // Raw bytes of a block of entries, one stream per column; strings are stored NUL-terminated.
+    struct CsvChunk {
+        std::vector<std::vector<char>> data;
+    };
+
+    CsvChunk ReadCsvChunk(TreeColumns& reader, const Long64_t first, const Long64_t last) {
+        const auto& cols = reader.Columns();
+        CsvChunk chunk;
+        chunk.data.resize(cols.size());
+
+        for (Long64_t entry = first; entry < last; ++entry) {
+            reader.Read(entry);
+            for (std::size_t i = 0; i < cols.size(); ++i) {
+                const auto& c = cols[i];
+                const std::size_t n = c.type == TreeColumns::Type::Str
+                                          ? std::strlen(TreeColumns::String(c)) + 1
+                                          : TreeColumns::Size(c.type) * c.width;
+                chunk.data[i].insert(chunk.data[i].end(), c.buffer.data(), c.buffer.data() + n);
+            }
+        }
+        return chunk;
+    }
+
+    template <typename T>
+    const char* AppendNumber(std::string& out, const char* p) {
+        T v;
+        std::memcpy(&v, p, sizeof(T));
+        char buf[32];
+        const auto res = std::to_chars(buf, buf + sizeof(buf), v);
+        out.append(buf, res.ptr);
+        return p + sizeof(T);
+    }
+
+    const char* AppendValue(std::string& out, const TreeColumns::Type type, const char* p) {
+        using Type = TreeColumns::Type;
+        switch (type) {
+        case Type::I8: return AppendNumber<std::int8_t>(out, p);
+        case Type::U8: return AppendNumber<std::uint8_t>(out, p);
+        case Type::I16: return AppendNumber<std::int16_t>(out, p);
+        case Type::U16: return AppendNumber<std::uint16_t>(out, p);
+        case Type::I32: return AppendNumber<std::int32_t>(out, p);
+        case Type::U32: return AppendNumber<std::uint32_t>(out, p);
+        case Type::I64: return AppendNumber<std::int64_t>(out, p);
+        case Type::U64: return AppendNumber<std::uint64_t>(out, p);
+        case Type::F32: return AppendNumber<float>(out, p);
+        case Type::F64: return AppendNumber<double>(out, p);
+        case Type::Str: break;
+        }
+        return p;
+    }
+
+    const char* AppendString(std::string& out, const char* p) {
+        const std::size_t len = std::strlen(p);
+        const std::string_view s(p, len);
+        if (s.find_first_of(",\"\n") == std::string_view::npos) {
+            out.append(s);
+        } else {
+            out += '"';
+            for (const char c : s) {
+                if (c == '"') out += "\"\"";
+                else out += c;
+            }
+            out += '"';
+        }
+        return p + len + 1;
     }
 
-    auto* leaves = tree->GetListOfLeaves();
-    if (!leaves || leaves->GetEntries() == 0) {
-        throw std::runtime_error("No leaves found in tree: " + treeName);
+    std::string FormatCsvChunk(const std::vector<CsvColumn>& cols, const CsvChunk& chunk, const Long64_t rows) {
+        std::vector<const char*> cursor(cols.size());
+        std::size_t bytes = 0;
+        for (std::size_t i = 0; i < cols.size(); ++i) {
+            cursor[i] = chunk.data[i].data();
+            bytes += chunk.data[i].size();
+        }
+
+        std::string out;
+        out.reserve(bytes * 3);
+        for (Long64_t r = 0; r < rows; ++r) {
+            for (std::size_t i = 0; i < cols.size(); ++i) {
+                if (i) out += ',';
+                const auto& c = cols[i];
+                if (c.type == TreeColumns::Type::Str) {
+                    cursor[i] = AppendString(out, cursor[i]);
+                } else if (c.width == 1) {
+                    cursor[i] = AppendValue(out, c.type, cursor[i]);
+                } else {
+                    out += '"';
+                    for (int k = 0; k < c.width; ++k) {
+                        if (k) out += ';';
+                        cursor[i] = AppendValue(out, c.type, cursor[i]);
+                    }
+                    out += '"';
+                }
+            }
+            out += '\n';
+        }
+        return out;
     }
+}
+
+// Entries are read sequentially into typed blocks; blocks are formatted on worker threads
+// (at most formatThreads in flight) and written in order.
+void PostProcessing::ExportTreeToCsv(TTree* tree,
+                                     const std::string& csvPath,
+                                     const unsigned formatThreads) {
+    TreeColumns reader(tree);
+    const auto& cols = reader.Columns();
 
-    std::ofstream out(csvPath);
+    std::vector<CsvColumn> layout;
+    layout.reserve(cols.size());
+    for (const auto& c : cols) layout.push_back({c.type, c.width});
+
+    std::ofstream out(csvPath, std::ios::binary);
     if (!out.is_open()) {
         throw std::runtime_error("Cannot open output CSV: " + csvPath);
     }
 
-
-    const int nLeaves = leaves->GetEntries();
-    for (int i = 0; i < nLeaves; ++i) {
-        auto* leaf = dynamic_cast<TLeaf*>(leaves->At(i));
-        out << (leaf ? leaf->GetName() : "unknown");
-        if (i + 1 != nLeaves) out << ",";
+    for (std::size_t i = 0; i < cols.size(); ++i) {
+        out << cols[i].name << (i + 1 != cols.size() ? "," : "\n");
     }
-    out << "\n";
 
+    tree->SetCacheSize(64 * 1024 * 1024);
+    tree->AddBranchToCache("*", true);
 
-    const Long64_t nEntries = tree->GetEntries();
-    for (Long64_t entry = 0; entry < nEntries; ++entry) {
-        tree->GetEntry(entry);
+    std::deque<std::future<std::string>> pending;
+    auto writeFront = [&]() {
+        const std::string text = pending.front().get();
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        pending.pop_front();
+    };
 
-        for (int i = 0; i < nLeaves; ++i) {
-            auto* leaf = dynamic_cast<TLeaf*>(leaves->At(i));
-            if (!leaf) {
-                out << "";
-                if (i + 1 != nLeaves) out << ",";
-                continue;
-            }
+    const Long64_t nEntries = reader.Entries();
+    for (Long64_t first = 0; first < nEntries; first += kCsvChunkRows) {
+        const Long64_t last = std::min(nEntries, first + kCsvChunkRows);
+        auto chunk = std::make_shared<CsvChunk>(ReadCsvChunk(reader, first, last));
 
-            if (leaf->InheritsFrom(TLeafC::Class())) {
-                auto* lc = dynamic_cast<TLeafC*>(leaf);
-                std::string s = lc->GetValueString();
-
-                bool needQuotes = s.find(',') != std::string::npos ||
-                    s.find('"') != std::string::npos ||
-                    s.find('\n') != std::string::npos;
-                if (needQuotes) {
-                    std::string esc;
-                    esc.reserve(s.size() + 8);
-                    for (char c : s) {
-                        if (c == '"') esc += "\"\"";
-                        else esc += c;
-                    }
-                    out << "\"" << esc << "\"";
-                } else {
-                    out << s;
-                }
-            } else {
-                int nData = leaf->GetNdata();
-                if (nData <= 1) {
-                    double v = leaf->GetValue(0);
-                    out << std::setprecision(17) << v;
-                } else {
-                    std::ostringstream cell;
-                    cell << std::setprecision(17);
-                    for (int k = 0; k < nData; ++k) {
-                        if (k) cell << ";";
-                        cell << leaf->GetValue(k);
-                    }
-                    out << "\"" << cell.str() << "\"";
-                }
-            }
+        if (pending.size() >= std::max(1u, formatThreads)) writeFront();
+        pending.push_back(std::async(std::launch::async, [&layout, chunk, rows = last - first]() {
+            return FormatCsvChunk(layout, *chunk, rows);
+        }));
+    }
+    while (!pending.empty()) writeFront();
 
-            if (i + 1 != nLeaves) out << ",";
-        }
-        out << "\n";
+    if (!out) {
+        throw std::runtime_error("Failed writing CSV: " + csvPath);
     }
+}
 
-    out.close();
+void PostProcessing::ExportTree(const std::string& treeName, const unsigned formatThreads) const {
+    const auto chain = MakeChain(treeName);
+    if (!chain) {
+        throw std::runtime_error("TTree/NTuple not found: " + treeName);
+    }
+    if (settings.exportFormat != "binary") {
+        ExportTreeToCsv(chain.get(), (fs::path(csvDir) / (treeName + ".csv")).string(), formatThreads);
+    }
+    if (settings.exportFormat != "csv") {
+        ColumnarExport::Write(chain.get(), (fs::path(columnarDir) / (treeName + ".ncol")).string());
+    }
 }
 
+// Every tree is exported on its own thread with its own chain.
 void PostProcessing::ExtractNtData() {
-    fs::create_directories(csvDir);
+    std::vector<std::string> trees = {"edep", "primary"};
 
-    ExportTreeToCsv("edep", (fs::path(csvDir) / "edep.csv").string());
-    ExportTreeToCsv("primary", (fs::path(csvDir) / "primary.csv").string());
+    if (settings.saveSecondaries) {
+        trees.insert(trees.end(), {"event", "interactions"});
+    }
 
-    if (saveSecondaries) {
-        ExportTreeToCsv("event", (fs::path(csvDir) / "event.csv").string());
-        ExportTreeToCsv("interactions", (fs::path(csvDir) / "interactions.csv").string());
+    if (settings.useOptics) {
+        trees.insert(trees.end(), {"sipm_event", "sipm_ch"});
     }
 
-    if (useOptics) {
-        ExportTreeToCsv("sipm_event", (fs::path(csvDir) / "sipm_event.csv").string());
-        ExportTreeToCsv("sipm_ch", (fs::path(csvDir) / "sipm_ch.csv").string());
+    if (settings.savePhotons) {
+        trees.insert(trees.end(), {"photons_count", "photons"});
     }
 
-    if (savePhotons) {
-        ExportTreeToCsv("photons_count", (fs::path(csvDir) / "photons_count.csv").string());
-        ExportTreeToCsv("photons", (fs::path(csvDir) / "photons.csv").string());
+    if (settings.exportFormat != "binary") fs::create_directories(csvDir);
+    if (settings.exportFormat != "csv") fs::create_directories(columnarDir);
+
+    const unsigned cores = settings.threads > 0 ? settings.threads : std::max(1u, std::thread::hardware_concurrency());
+    const unsigned formatThreads = std::max(1u, cores / static_cast<unsigned>(trees.size()));
+
+    std::vector<std::future<void>> jobs;
+    jobs.reserve(trees.size());
+    for (const auto& name : trees) {
+        jobs.push_back(std::async(std::launch::async, [this, name, formatThreads]() {
+            ExportTree(name, formatThreads);
+        }));
     }
+    for (auto& job : jobs) job.get();
 }
 
 void PostProcessing::SaveEffArea() {
@@ -236,12 +387,12 @@ void PostProcessing::SaveEffArea() {
     TH1* trigOpt = trig;
     TH1* effArea = GetHistOrThrow("effAreaHist");
     TH1* effAreaOpt = effArea;
-    if (useOptics) {
+    if (settings.useOptics) {
         trigOpt = GetHistOrThrow("trigOptEnergyHist");
         effAreaOpt = GetHistOrThrow("effAreaOptHist");
     }
 
-    if (trig->GetNbinsX() != nBins || effArea->GetNbinsX() != nBins) {
+    if (trig->GetNbinsX() != settings.nBins || effArea->GetNbinsX() != settings.nBins) {
         throw std::runtime_error("Histogram binning mismatch among genEnergyHist/trigEnergyHist/effAreaHist");
     }
 
@@ -255,7 +406,7 @@ void PostProcessing::SaveEffArea() {
     SaveHistPng("trigEnergyHist", (fs::path(histogramsDir) / "trigEnergyHist.png").string(),
                 "N_{trig} vs Energy", "Counts", true, false);
 
-    if (useOptics) {
+    if (settings.useOptics) {
         SaveHistPng("effAreaOptHist", (fs::path(effectiveAreaDir) / "effective_area_opt.png").string(),
                     "Effective Area vs Energy", "Effective Area [cm^{2}]", false, true);
         SaveHistPng("trigOptEnergyHist", (fs::path(histogramsDir) / "trigOptEnergyHist.png").string(),
@@ -273,7 +424,7 @@ void PostProcessing::SaveEffArea() {
 
     auto* ax = gen->GetXaxis();
 
-    for (int i = 1; i <= nBins; ++i) {
+    for (int i = 1; i <= settings.nBins; ++i) {
         double eLow = ax->GetBinLowEdge(i);
         double eHigh = ax->GetBinUpEdge(i);
         double eWidth = eHigh - eLow;
@@ -288,7 +439,7 @@ void PostProcessing::SaveEffArea() {
         double aeffErr = EffAreaErrFromCounts(n0, n, aeff);
         double aeffErrOpt = EffAreaErrFromCounts(n0, nOpt, aeffOpt);
 
-        if (!useOptics) {
+        if (!settings.useOptics) {
             nOpt = aeffOpt = aeffErrOpt = 0;
         }
 
@@ -306,6 +457,10 @@ void PostProcessing::SaveEffArea() {
     }
 
     out.close();
+
+    if (settings.bootstrapReplicas > 0) {
+        SaveBootstrap(effectiveAreaDir, "effective_area");
+    }
 }
 
 void PostProcessing::SaveSensitivity() {
@@ -316,12 +471,12 @@ void PostProcessing::SaveSensitivity() {
     TH1* sens = GetHistOrThrow("sensitivityHist");
     TH1* trigOpt = trig;
     TH1* sensOpt = sens;
-    if (useOptics) {
+    if (settings.useOptics) {
         trigOpt = GetHistOrThrow("trigOptEnergyHist");
         sensOpt = GetHistOrThrow("sensitivityOptHist");
     }
 
-    if (trig->GetNbinsX() != nBins || sens->GetNbinsX() != nBins) {
+    if (trig->GetNbinsX() != settings.nBins || sens->GetNbinsX() != settings.nBins) {
         throw std::runtime_error("Histogram binning mismatch among genEnergyHist/trigEnergyHist/sensitivityHist");
     }
 
@@ -334,7 +489,7 @@ void PostProcessing::SaveSensitivity() {
     SaveHistPng("trigEnergyHist", (fs::path(histogramsDir) / "trigEnergyHist.png").string(),
                 "N_{trig} vs Energy", "Counts", true, false);
 
-    if (useOptics) {
+    if (settings.useOptics) {
         SaveHistPng("sensitivityOptHist", (fs::path(sensitivityDir) / "sensitivity_opt.png").string(),
                     "Sensitivity vs Energy", "Sensitivity [cm^{2} \\cdot sr]", false, true);
         SaveHistPng("trigOptEnergyHist", (fs::path(histogramsDir) / "trigOptEnergyHist.png").string(),
@@ -351,7 +506,7 @@ void PostProcessing::SaveSensitivity() {
 
     auto* ax = gen->GetXaxis();
 
-    for (int i = 1; i <= nBins; ++i) {
+    for (int i = 1; i <= settings.nBins; ++i) {
         double eLow = ax->GetBinLowEdge(i);
         double eHigh = ax->GetBinUpEdge(i);
         double eWidth = eHigh - eLow;
@@ -363,7 +518,7 @@ void PostProcessing::SaveSensitivity() {
 
         double s_ = sens->GetBinContent(i);
         double sOpt = sensOpt->GetBinContent(i);
-        if (!useOptics) {
+        if (!settings.useOptics) {
             nOpt = sOpt = 0;
         }
 
@@ -379,449 +534,485 @@ void PostProcessing::SaveSensitivity() {
     }
 
     out.close();
-}
 
-void PostProcessing::SaveTrigEdepCsv() {
-    TTree* primary = nullptr;
-    rootFile->GetObject("primary", primary);
-    if (!primary) {
-        throw std::runtime_error("TTree not found: primary");
+    if (settings.bootstrapReplicas > 0) {
+        SaveBootstrap(sensitivityDir, "sensitivity");
     }
+}
 
-    Int_t eventID_p = 0;
-    double E0 = 0.0;
-
-    primary->SetBranchStatus("*", false);
-    primary->SetBranchStatus("eventID", true);
-    primary->SetBranchStatus("E_MeV", true);
+namespace {
+    constexpr std::size_t kBootstrapBlock = 65536;
+
+    // Column buffers of one cursor; each tree binds the fields it has.
+    struct EventRow {
+        Int_t job = 0;
+        Int_t eventID = 0;
+        double e0 = 0.0;
+        double edep = 0.0;
+        double weight = 1.0;
+        Char_t name[64] = {};
+        Int_t npe[3]{};
+        Int_t ch = 0;
+    };
 
-    primary->SetBranchAddress("eventID", &eventID_p);
-    primary->SetBranchAddress("E_MeV", &E0);
+    // One tree of one ntuple file, read in (job, eventID) order. A first pass over the job and eventID branches
+    // checks the order. Per-thread files are written in order and are then read sequentially in constant memory.
+    // A merged file interleaves workers and jobs and is walked through a TTreeIndex instead, which holds two
+    // 64-bit values per entry, so memory grows with the number of rows. Files written before the job column read
+    // as job 0.
+    class EventCursor {
+    public:
+        EventCursor(const std::string& path, const char* treeName) : file(TFile::Open(path.c_str(), "READ")) {
+            if (!file || file->IsZombie()) {
+                throw std::runtime_error("Failed to open ROOT file: " + path);
+            }
+            file->GetObject(treeName, tree);
+            if (!tree) return;
+
+            tree->SetBranchStatus("*", false);
+            const bool hasJob = tree->GetBranch("job") != nullptr;
+            if (hasJob) Bind("job", &row.job);
+            Bind("eventID", &row.eventID);
+            entries = tree->GetEntries();
+            if (!Sorted()) {
+                // Entry$ as minor key keeps the rows of one event in the order they were written.
+                tree->BuildIndex(hasJob ? "job*4294967296+eventID" : "eventID", "Entry$");
+                order = static_cast<TTreeIndex*>(tree->GetTreeIndex())->GetIndex();
+            }
+        }
 
-    std::unordered_map<int, double> e0ByEvent;
-    e0ByEvent.reserve(std::max<Long64_t>(1, primary->GetEntries()));
+        EventCursor(const EventCursor&) = delete;
+        EventCursor& operator=(const EventCursor&) = delete;
 
-    const Long64_t nP = primary->GetEntries();
-    for (Long64_t i = 0; i < nP; ++i) {
-        primary->GetEntry(i);
-        e0ByEvent[eventID_p] = E0;
-    }
+        EventRow row;
 
-    TTree* edep = nullptr;
-    rootFile->GetObject("edep", edep);
-    if (!edep) {
-        throw std::runtime_error("TTree not found: edep");
-    }
+        [[nodiscard]] TTree* Tree() const { return tree; }
 
-    Int_t eventID_e = 0;
+        void Bind(const char* branch, void* address) {
+            tree->SetBranchStatus(branch, true);
+            tree->SetBranchAddress(branch, address);
+        }
 
-    Char_t det_name[64] = {};
+        // Loads the first row; call once all branches are bound.
+        void Start() {
+            pos = -1;
+            Next();
+        }
 
-    double edep_MeV = 0.0;
+        void Next() {
+            if (++pos < entries) tree->GetEntry(order ? order[pos] : pos);
+        }
 
-    edep->SetBranchStatus("*", false);
-    edep->SetBranchStatus("eventID", true);
-    edep->SetBranchStatus("det_name", true);
-    edep->SetBranchStatus("edep_MeV", true);
+        [[nodiscard]] bool Done() const { return pos >= entries; }
+        [[nodiscard]] Long64_t Key() const { return KeyOf(row.job, row.eventID); }
 
-    edep->SetBranchAddress("eventID", &eventID_e);
-    edep->SetBranchAddress("det_name", det_name);
-    edep->SetBranchAddress("edep_MeV", &edep_MeV);
+        static Long64_t KeyOf(const Int_t job, const Int_t eventID) {
+            return static_cast<Long64_t>(job) << 32 | static_cast<std::uint32_t>(eventID);
+        }
 
-    struct Agg {
-        double crystal = 0.0;
-        double veto = 0.0;
-        double bottomVeto = 0.0;
+    private:
+        std::unique_ptr<TFile> file;
+        TTree* tree = nullptr;
+        Long64_t entries = 0;
+        Long64_t pos = 0;
+        const Long64_t* order = nullptr;
+
+        bool Sorted() {
+            Long64_t last = std::numeric_limits<Long64_t>::min();
+            for (Long64_t i = 0; i < entries; ++i) {
+                tree->GetEntry(i);
+                if (Key() < last) return false;
+                last = Key();
+            }
+            return true;
+        }
     };
 
-    std::unordered_map<int, Agg> agg;
-    agg.reserve(std::max<Long64_t>(1, edep->GetEntries()));
-
-    const Long64_t nE = edep->GetEntries();
-    for (Long64_t i = 0; i < nE; ++i) {
-        edep->GetEntry(i);
+    using Cursors = std::vector<std::unique_ptr<EventCursor>>;
 
-        auto& a = agg[eventID_e];
-
-        if (std::strcmp(det_name, "Crystal") == 0) {
-            a.crystal += edep_MeV;
-        } else if (std::strcmp(det_name, "Veto") == 0) {
-            a.veto += edep_MeV;
-        } else if (std::strcmp(det_name, "BottomVeto") == 0) {
-            a.bottomVeto += edep_MeV;
-        }
-    }
-
-    const std::string outPath = (fs::path(histogramsDir) / "trig_edep.csv").string();
-    std::ofstream out(outPath);
-    if (!out.is_open()) {
-        throw std::runtime_error("Cannot open output CSV: " + outPath);
+    int SubdetIndex(const char* subdet) {
+        if (std::strcmp(subdet, "Crystal") == 0) return 0;
+        if (std::strcmp(subdet, "Veto") == 0) return 1;
+        if (std::strcmp(subdet, "BottomVeto") == 0) return 2;
+        return -1;
     }
 
-    out << "eventID,E0,Crystal_only_edep\n";
-    out << std::setprecision(17);
-
-    std::vector<int> events;
-    events.reserve(e0ByEvent.size());
-    for (const auto& kv : e0ByEvent) events.push_back(kv.first);
-    std::sort(events.begin(), events.end());
-
-    for (int evt : events) {
-        const double e0 = e0ByEvent.at(evt);
-
-        double crystal_only = 0.0;
-        auto it = agg.find(evt);
-        if (it != agg.end()) {
-            const double c = it->second.crystal;
-            const double v = it->second.veto;
-            const double b = it->second.bottomVeto;
-
-            if (c > 0.0 && v + b == 0.0) {
-                crystal_only = c;
-            }
+    std::ofstream OpenCsv(const fs::path& path) {
+        std::ofstream out(path);
+        if (!out.is_open()) {
+            throw std::runtime_error("Cannot open output CSV: " + path.filename().string());
         }
-
-        out << evt << "," << e0 << "," << crystal_only << "\n";
+        return out;
     }
-
-    out.close();
 }
 
+// One k-way merge over the primary, edep, sipm_event and sipm_ch cursors writes every event out as soon as it is
+// complete; the bootstrap sums and storedCounts are filled on the same pass.
+void PostProcessing::SaveEventCsvs() {
+    if (eventsStreamed) return;
 
-void PostProcessing::SaveEdepCsv() {
-    TTree* edep = nullptr;
-    rootFile->GetObject("edep", edep);
-    if (!edep) {
-        throw std::runtime_error("TTree not found: edep");
-    }
-
-    Int_t eventID_e = 0;
-    Char_t det_name[64] = {};
-    double edep_MeV = 0.0;
-
-    edep->SetBranchStatus("*", false);
-    edep->SetBranchStatus("eventID", true);
-    edep->SetBranchStatus("det_name", true);
-    edep->SetBranchStatus("edep_MeV", true);
-
-    edep->SetBranchAddress("eventID", &eventID_e);
-    edep->SetBranchAddress("det_name", det_name);
-    edep->SetBranchAddress("edep_MeV", &edep_MeV);
-
-    struct DetectorEdep {
-        double crystal = 0.0;
-        double veto = 0.0;
-        double bottomVeto = 0.0;
+    auto open = [this](const char* treeName) {
+        Cursors cursors;
+        for (const auto& path : ntupleFiles) {
+            auto c = std::make_unique<EventCursor>(path, treeName);
+            if (c->Tree()) cursors.push_back(std::move(c));
+        }
+        if (cursors.empty()) {
+            throw std::runtime_error(std::string("TTree not found: ") + treeName);
+        }
+        return cursors;
     };
 
-    std::unordered_map<int, DetectorEdep> edepMap;
-    edepMap.reserve(std::max<Long64_t>(1, edep->GetEntries()));
-
-    const Long64_t nEntries = edep->GetEntries();
-    for (Long64_t i = 0; i < nEntries; ++i) {
-        edep->GetEntry(i);
-
-        auto& deps = edepMap[eventID_e];
+    Cursors primary = open("primary");
+    for (auto& c : primary) {
+        c->Bind("E_MeV", &c->row.e0);
+        BindWeight(c->Tree(), &c->row.weight);
+    }
+
+    Cursors edep = open("edep");
+    for (auto& c : edep) {
+        c->Bind("det_name", c->row.name);
+        c->Bind("edep_MeV", &c->row.edep);
+        BindWeight(c->Tree(), &c->row.weight);
+    }
+
+    const bool optics = settings.useOptics;
+    Cursors sipmEvent;
+    Cursors sipmCh;
+    std::vector<Int_t> channels[3];  // crystal, veto, bottom veto
+    if (optics) {
+        sipmEvent = open("sipm_event");
+        for (auto& c : sipmEvent) {
+            c->Bind("npe_crystal", &c->row.npe[0]);
+            c->Bind("npe_veto", &c->row.npe[1]);
+            c->Bind("npe_bottom_veto", &c->row.npe[2]);
+            BindWeight(c->Tree(), &c->row.weight);
+        }
 
-        if (std::strcmp(det_name, "Crystal") == 0) {
-            deps.crystal += edep_MeV;
-        } else if (std::strcmp(det_name, "Veto") == 0) {
-            deps.veto += edep_MeV;
-        } else if (std::strcmp(det_name, "BottomVeto") == 0) {
-            deps.bottomVeto += edep_MeV;
+        // The channel columns go into the CSV headers, so sipm_ch is scanned for them first.
+        sipmCh = open("sipm_ch");
+        std::set<Int_t> seen[3];
+        for (auto& c : sipmCh) {
+            c->Bind("subdet", c->row.name);
+            c->Bind("ch", &c->row.ch);
+            for (c->Start(); !c->Done(); c->Next()) {
+                if (const int sub = SubdetIndex(c->row.name); sub >= 0) seen[sub].insert(c->row.ch);
+            }
+            c->Bind("npe", &c->row.npe[0]);
         }
+        for (int sub = 0; sub < 3; ++sub) channels[sub].assign(seen[sub].begin(), seen[sub].end());
     }
 
-    const std::string outPath = (fs::path(histogramsDir) / "edep.csv").string();
-    std::ofstream out(outPath);
-    if (!out.is_open()) {
-        throw std::runtime_error("Cannot open output CSV: " + outPath);
+    std::vector<EventCursor*> all;
+    for (const Cursors* group : {&primary, &edep, &sipmEvent, &sipmCh}) {
+        for (auto& c : *group) {
+            c->Start();
+            all.push_back(c.get());
+        }
     }
 
-    out << "eventID,Trigger,Crystal_edep_MeV,Veto_edep_MeV,BottomVeto_edep_MeV\n";
-    out << std::setprecision(17);
+    std::ofstream trigEdepOut = OpenCsv(fs::path(histogramsDir) / "trig_edep.csv");
+    trigEdepOut << "job,eventID,E0,Crystal_only_edep,weight\n";
+    trigEdepOut << std::setprecision(17);
 
-    std::vector<int> eventIDs;
-    eventIDs.reserve(edepMap.size());
-    for (const auto& kv : edepMap) {
-        eventIDs.push_back(kv.first);
-    }
-    std::sort(eventIDs.begin(), eventIDs.end());
+    std::ofstream edepOut = OpenCsv(fs::path(histogramsDir) / "edep.csv");
+    edepOut << "job,eventID,Trigger,Crystal_edep_MeV,Veto_edep_MeV,BottomVeto_edep_MeV,weight\n";
+    edepOut << std::setprecision(17);
 
-    for (int evtID : eventIDs) {
-        const auto& deps = edepMap.at(evtID);
+    std::ofstream trigOptOut;
+    std::ofstream channelOut[3];
+    std::vector<Int_t> channelRow[3];
+    if (optics) {
+        const fs::path opticDir = fs::path(runDir) / "optic";
+        fs::create_directories(opticDir);
 
-        int trigger = deps.crystal > 0.0 &&
-                      deps.veto == 0.0 &&
-                      deps.bottomVeto == 0.0
-                          ? 1
-                          : 0;
+        trigOptOut = OpenCsv(opticDir / "trig_opt.csv");
+        trigOptOut << "job,eventID,trigger_opt,trigger_edep,Crystal_npe,Veto_npe,BottomVeto_npe,weight\n";
 
-        out << evtID << ","
-            << trigger << ","
-            << deps.crystal << ","
-            << deps.veto << ","
-            << deps.bottomVeto << "\n";
+        static const char* fileNames[3] = {"Crystal_channel.csv", "Veto_channel.csv", "BottomVeto_channel.csv"};
+        for (int sub = 0; sub < 3; ++sub) {
+            if (channels[sub].empty()) continue;
+            channelOut[sub] = OpenCsv(opticDir / fileNames[sub]);
+            channelOut[sub] << "job,eventID";
+            for (Int_t ch : channels[sub]) {
+                channelOut[sub] << ",ch" << ch;
+            }
+            channelOut[sub] << "\n";
+            channelRow[sub].assign(channels[sub].size(), 0);
+        }
     }
 
-    out.close();
-}
-
-void PostProcessing::SaveOpticsCsv() {
-    std::string opticDir = (fs::path(runDir) / "optic").string();
-    fs::create_directories(opticDir);
-
-    std::unordered_map<int, int> edepTriggerMap;
-
-    TTree* edep = nullptr;
-    rootFile->GetObject("edep", edep);
-    if (edep) {
-        Int_t eventID_e = 0;
-        Char_t det_name[64] = {};
-        double edep_MeV = 0.0;
-
-        edep->SetBranchStatus("*", true);
-
-        edep->SetBranchAddress("eventID", &eventID_e);
-        edep->SetBranchAddress("det_name", det_name);
-        edep->SetBranchAddress("edep_MeV", &edep_MeV);
-
-        struct DetectorEdep {
-            double crystal = 0.0;
-            double veto = 0.0;
-            double bottomVeto = 0.0;
-        };
-
-        std::unordered_map<int, DetectorEdep> edepMap;
-        const Long64_t nEntries = edep->GetEntries();
-        for (Long64_t i = 0; i < nEntries; ++i) {
-            edep->GetEntry(i);
-
-            auto& deps = edepMap[eventID_e];
+    // Bootstrap events are numbered in (job, eventID) order, as Resample over the whole run would number them.
+    std::unique_ptr<Bootstrap> bootstrap;
+    const TAxis* ax = nullptr;
+    Bootstrap::Sample sample;
+    std::uint64_t sampled = 0;
+    if (settings.bootstrapReplicas > 0 && settings.eMinMeV < settings.eMaxMeV) {
+        ax = GetHistOrThrow("genEnergyHist")->GetXaxis();
+        bootstrap = std::make_unique<Bootstrap>(settings.bootstrapReplicas, settings.bootstrapSeed, settings.threads);
+        sample.nBins = ax->GetNbins();
+        bootstrapSums = bootstrap->Empty(sample.nBins);
+    }
+    storedCounts = {};
+
+    auto flushSample = [&]() {
+        bootstrap->Accumulate(sample, sampled, bootstrapSums);
+        sampled += sample.bin.size();
+        sample.bin.clear();
+        sample.weight.clear();
+        sample.pass.clear();
+    };
 
-            if (std::strcmp(det_name, "Crystal") == 0) {
-                deps.crystal += edep_MeV;
-            } else if (std::strcmp(det_name, "Veto") == 0) {
-                deps.veto += edep_MeV;
-            } else if (std::strcmp(det_name, "BottomVeto") == 0) {
-                deps.bottomVeto += edep_MeV;
+    for (;;) {
+        const EventCursor* first = nullptr;
+        for (const auto* c : all) {
+            if (!c->Done() && (!first || c->Key() < first->Key())) first = c;
+        }
+        if (!first) break;
+        const Long64_t id = first->Key();
+        const std::string eventKey = std::to_string(first->row.job) + "," + std::to_string(first->row.eventID);
+
+        EventSummary ev;
+        for (auto& c : primary) {
+            for (; !c->Done() && c->Key() == id; c->Next()) {
+                ev.e0 = c->row.e0;
+                ev.weight = c->row.weight;
+                ev.flags |= EventSummary::kPrimary;
             }
         }
 
-        for (const auto& [evtID, deps] : edepMap) {
-            edepTriggerMap[evtID] = deps.crystal > 0.0 && deps.veto == 0.0 && deps.bottomVeto == 0.0 ? 1 : 0;
+        for (auto& c : edep) {
+            for (; !c->Done() && c->Key() == id; c->Next()) {
+                const char* det_name = c->row.name;
+                const double edep_MeV = c->row.edep;
+                ev.weight = c->row.weight;
+                ev.flags |= EventSummary::kEdep;
+
+                if (std::strcmp(det_name, "Crystal") == 0) {
+                    ev.crystal += edep_MeV;
+                } else if (std::strcmp(det_name, "Veto") == 0) {
+                    ev.veto += edep_MeV;
+                    ev.hits |= EventSummary::kAC;
+                } else if (std::strcmp(det_name, "BottomVeto") == 0) {
+                    ev.bottomVeto += edep_MeV;
+                } else if (std::strcmp(det_name, "PostCaloAC") == 0) {
+                    ev.hits |= EventSummary::kAC;
+                } else if (std::strcmp(det_name, "Trigger1Lower") == 0) {
+                    ev.hits |= EventSummary::kT1Lower;
+                } else if (std::strcmp(det_name, "Trigger1Upper") == 0) {
+                    ev.hits |= EventSummary::kT1Upper;
+                } else if (std::strcmp(det_name, "Trigger2Lower") == 0) {
+                    ev.hits |= EventSummary::kT2Lower;
+                } else if (std::strcmp(det_name, "Trigger2Upper") == 0) {
+                    ev.hits |= EventSummary::kT2Upper;
+                }
+            }
         }
-    }
 
-    TTree* sipmEvent = nullptr;
-    rootFile->GetObject("sipm_event", sipmEvent);
-    if (!sipmEvent) {
-        throw std::runtime_error("TTree not found: sipm_event");
-    }
+        for (auto& c : sipmEvent) {
+            for (; !c->Done() && c->Key() == id; c->Next()) {
+                std::copy_n(c->row.npe, 3, ev.npe);
+                ev.weight = c->row.weight;
+                ev.flags |= EventSummary::kSiPM;
+            }
+        }
 
-    Int_t eventID = 0;
-    Int_t npe_crystal = 0;
-    Int_t npe_veto = 0;
-    Int_t npe_bottom_veto = 0;
+        // A channel repeated within the event keeps its last npe, rows being read in write order.
+        for (auto& c : sipmCh) {
+            for (; !c->Done() && c->Key() == id; c->Next()) {
+                const int sub = SubdetIndex(c->row.name);
+                if (sub < 0) continue;
+                const auto& chs = channels[sub];
+                channelRow[sub][std::lower_bound(chs.begin(), chs.end(), c->row.ch) - chs.begin()] = c->row.npe[0];
+            }
+        }
 
-    sipmEvent->SetBranchStatus("*", true);
+        if (ev.flags & EventSummary::kPrimary) {
+            const double crystal_only = ev.crystal > 0.0 && ev.veto + ev.bottomVeto == 0.0 ? ev.crystal : 0.0;
+            trigEdepOut << eventKey << "," << ev.e0 << "," << crystal_only << "," << ev.weight << "\n";
 
-    sipmEvent->SetBranchAddress("eventID", &eventID);
-    sipmEvent->SetBranchAddress("npe_crystal", &npe_crystal);
-    sipmEvent->SetBranchAddress("npe_veto", &npe_veto);
-    sipmEvent->SetBranchAddress("npe_bottom_veto", &npe_bottom_veto);
+            if (bootstrap) {
+                sample.bin.push_back(ax->FindBin(ev.e0) - 1);
+                sample.weight.push_back(ev.weight);
+                sample.pass.push_back(ev.TOFTrigger() ? 1 : 0);
+                if (sample.bin.size() == kBootstrapBlock) flushSample();
+            }
+        }
 
-    struct EventInfo {
-        Int_t crystal_npe = 0;
-        Int_t veto_npe = 0;
-        Int_t bottom_veto_npe = 0;
-        Int_t trigger = 0;
-    };
+        if (ev.flags & EventSummary::kEdep) {
+            // Same classes as the run counters in EventAction; Veto and PostCaloAC are the anticoincidence.
+            if (ev.crystal > 0.0) {
+                (ev.hits & EventSummary::kAC ? storedCounts.crystalAndVeto : storedCounts.crystalOnly) += ev.weight;
+            }
 
-    std::unordered_map<Int_t, EventInfo> eventMap;
-    eventMap.reserve(std::max<Long64_t>(1, sipmEvent->GetEntries()));
+            edepOut << eventKey << ","
+                << (ev.EdepTrigger() ? 1 : 0) << ","
+                << ev.crystal << ","
+                << ev.veto << ","
+                << ev.bottomVeto << ","
+                << ev.weight << "\n";
+        }
 
-    const Long64_t nEvents = sipmEvent->GetEntries();
-    for (Long64_t i = 0; i < nEvents; ++i) {
-        sipmEvent->GetEntry(i);
+        if (ev.flags & EventSummary::kSiPM) {
+            const int trigger_opt = ev.npe[0] > 0 && ev.npe[1] + ev.npe[2] == 0 ? 1 : 0;
+            trigOptOut << eventKey << ","
+                << trigger_opt << ","
+                << (ev.EdepTrigger() ? 1 : 0) << ","
+                << ev.npe[0] << ","
+                << ev.npe[1] << ","
+                << ev.npe[2] << ","
+                << ev.weight << "\n";
+
+            for (int sub = 0; sub < 3; ++sub) {
+                if (!channelOut[sub].is_open()) continue;
+                channelOut[sub] << eventKey;
+                for (Int_t npe : channelRow[sub]) {
+                    channelOut[sub] << "," << npe;
+                }
+                channelOut[sub] << "\n";
+            }
+        }
+        for (auto& r : channelRow) std::fill(r.begin(), r.end(), 0);
+    }
 
-        EventInfo info;
-        info.crystal_npe = npe_crystal;
-        info.veto_npe = npe_veto;
-        info.bottom_veto_npe = npe_bottom_veto;
-        info.trigger = npe_crystal > 0 && npe_veto + npe_bottom_veto == 0 ? 1 : 0;
+    if (bootstrap && !sample.bin.empty()) flushSample();
+    eventsStreamed = true;
 
-        eventMap[eventID] = info;
+    if (!settings.infoFile.empty()) {
+        SaveStoredCounts();
     }
+}
 
-    TTree* sipmCh = nullptr;
-    rootFile->GetObject("sipm_ch", sipmCh);
-    if (!sipmCh) {
-        throw std::runtime_error("TTree not found: sipm_ch");
+// The stored events are a prescaled sample of the run; weighting each by its prescale makes these counts
+// (and rates) unbiased estimates of the exact run counters in the Counts and Rates blocks.
+void PostProcessing::SaveStoredCounts() const {
+    std::ostringstream info;
+    info << std::setprecision(17);
+    info << "Crystal_only: " << storedCounts.crystalOnly << "\n\t";
+    info << "Veto_then_Crystal: " << storedCounts.crystalAndVeto;
+
+    if (settings.hasFlux && settings.histories > 0) {
+        try {
+            const RateResult rr = computeRate(settings.fluxType, settings.fluxParams, settings.fluxRange,
+                                              settings.areaCm2, settings.histories, storedCounts);
+            info << std::setprecision(6);
+            info << "\n\tRate_Crystal_only: " << rr.rateCrystal;
+            info << "\n\tRate_Both: " << rr.rateBoth;
+        }
+        catch (const std::exception&) {
+            info << "\n\tRate_Crystal_only: NaN";
+            info << "\n\tRate_Both: NaN";
+        }
     }
 
-    Int_t ch_eventID = 0;
-    char subdet[64] = {};
-    Int_t ch = 0;
-    Int_t npe = 0;
-
-    sipmCh->SetBranchStatus("*", true);
-    sipmCh->SetBranchAddress("eventID", &ch_eventID);
-    sipmCh->SetBranchAddress("subdet", subdet);
-    sipmCh->SetBranchAddress("ch", &ch);
-    sipmCh->SetBranchAddress("npe", &npe);
-
-    using ChannelMap = std::unordered_map<Int_t, std::unordered_map<Int_t, Int_t>>;
-    ChannelMap crystalChannels;
-    ChannelMap vetoChannels;
-    ChannelMap bottomVetoChannels;
-
-    std::set<Int_t> allCrystalChannels;
-    std::set<Int_t> allVetoChannels;
-    std::set<Int_t> allBottomVetoChannels;
-
-    const Long64_t nChEntries = sipmCh->GetEntries();
-    for (Long64_t i = 0; i < nChEntries; ++i) {
-        sipmCh->GetEntry(i);
-
-        std::string subdetStr(subdet);
+    WriteInfoBlock("Stored_counts", info.str());
+}
 
-        if (subdetStr == "Crystal") {
-            crystalChannels[ch_eventID][ch] = npe;
-            allCrystalChannels.insert(ch);
-        } else if (subdetStr == "Veto") {
-            vetoChannels[ch_eventID][ch] = npe;
-            allVetoChannels.insert(ch);
-        } else if (subdetStr == "BottomVeto") {
-            bottomVetoChannels[ch_eventID][ch] = npe;
-            allBottomVetoChannels.insert(ch);
-        }
+void PostProcessing::SaveBootstrap(const std::string& dir, const std::string& name) {
+    if (settings.areaCm2 <= 0.0) {
+        throw std::runtime_error("Bootstrap needs the generation area (Post_processing.Area)");
     }
+    SaveEventCsvs();
 
-    std::vector sortedCrystalChannels(allCrystalChannels.begin(), allCrystalChannels.end());
-    std::vector sortedVetoChannels(allVetoChannels.begin(), allVetoChannels.end());
-    std::vector sortedBottomVetoChannels(allBottomVetoChannels.begin(), allBottomVetoChannels.end());
+    const TAxis* ax = GetHistOrThrow("genEnergyHist")->GetXaxis();
+    const int nBins = ax->GetNbins();
 
-    std::sort(sortedCrystalChannels.begin(), sortedCrystalChannels.end());
-    std::sort(sortedVetoChannels.begin(), sortedVetoChannels.end());
-    std::sort(sortedBottomVetoChannels.begin(), sortedBottomVetoChannels.end());
+    const auto& rep = bootstrapSums;
+    const int R = rep.replicas;
 
-    std::ofstream trigOptFile(fs::path(opticDir) / "trig_opt.csv");
-    if (!trigOptFile.is_open()) {
-        throw std::runtime_error("Cannot open output CSV: trig_opt.csv");
+    // Replica curves, [bin * R + r]; empty bins read as zero like in RunAction.
+    std::vector<double> curve(static_cast<std::size_t>(nBins) * R, 0.0);
+    for (std::size_t k = 0; k < curve.size(); ++k) {
+        if (rep.total[k] > 0.0) curve[k] = settings.areaCm2 * rep.passed[k] / rep.total[k];
     }
 
-    trigOptFile << "eventID,trigger_opt,trigger_edep,Crystal_npe,Veto_npe,BottomVeto_npe\n";
-
-    std::vector<Int_t> allEventIDs;
-    allEventIDs.reserve(eventMap.size());
-    for (const auto& kv : eventMap) {
-        allEventIDs.push_back(kv.first);
+    std::ofstream out((fs::path(dir) / (name + "_bootstrap.csv")).string());
+    if (!out.is_open()) {
+        throw std::runtime_error("Cannot open output CSV: " + name + "_bootstrap.csv");
     }
-    std::sort(allEventIDs.begin(), allEventIDs.end());
-
-    for (Int_t evtID : allEventIDs) {
-        const auto& info = eventMap[evtID];
+    out << "E_low,E_high,E_center_geom,mean,std,p2.5,p16,p50,p84,p97.5\n";
+    out << std::setprecision(17);
 
-        int trigger_edep = 0;
-        auto it = edepTriggerMap.find(evtID);
-        if (it != edepTriggerMap.end()) {
-            trigger_edep = it->second;
-        }
+    std::vector<double> values(R);
+    for (int i = 0; i < nBins; ++i) {
+        std::copy_n(curve.begin() + static_cast<std::ptrdiff_t>(i) * R, R, values.begin());
+        const auto band = Bootstrap::Summarize(values);
 
-        trigOptFile << evtID << ","
-            << info.trigger << ","
-            << trigger_edep << ","
-            << info.crystal_npe << ","
-            << info.veto_npe << ","
-            << info.bottom_veto_npe << "\n";
+        const double eLow = ax->GetBinLowEdge(i + 1);
+        const double eHigh = ax->GetBinUpEdge(i + 1);
+        out << eLow << ","
+            << eHigh << ","
+            << GeomCenter(eLow, eHigh) << ","
+            << band.mean << ","
+            << band.std << ","
+            << band.p025 << ","
+            << band.p16 << ","
+            << band.p50 << ","
+            << band.p84 << ","
+            << band.p975 << "\n";
     }
-    trigOptFile.close();
-
-    if (!sortedCrystalChannels.empty()) {
-        std::ofstream crystalFile(fs::path(opticDir) / "Crystal_channel.csv");
-        if (!crystalFile.is_open()) {
-            throw std::runtime_error("Cannot open output CSV: Crystal_channel.csv");
-        }
-
-        crystalFile << "eventID";
-        for (Int_t ch : sortedCrystalChannels) {
-            crystalFile << ",ch" << ch;
-        }
-        crystalFile << "\n";
+    out.close();
 
-        for (Int_t evtID : allEventIDs) {
-            crystalFile << evtID;
+    std::ostringstream info;
+    info << "Replicas: " << R << "\n\t";
+    info << "Seed: " << settings.bootstrapSeed;
 
-            const auto& channels = crystalChannels[evtID];
-            for (Int_t ch : sortedCrystalChannels) {
-                auto it = channels.find(ch);
-                if (it != channels.end()) {
-                    crystalFile << "," << it->second;
-                } else {
-                    crystalFile << ",0";
-                }
-            }
-            crystalFile << "\n";
-        }
-        crystalFile.close();
-    }
+    if (settings.hasFlux) {
+        const EnergyRange er{ax->GetXmin(), ax->GetXmax()};
+        const auto w = foldingWeights(settings.fluxType, settings.fluxParams, er, nBins);
 
-    if (!sortedVetoChannels.empty()) {
-        std::ofstream vetoFile(fs::path(opticDir) / "Veto_channel.csv");
-        if (!vetoFile.is_open()) {
-            throw std::runtime_error("Cannot open output CSV: Veto_channel.csv");
+        std::vector<double> rates(R, 0.0);
+        for (int i = 0; i < nBins; ++i) {
+            const double* c = curve.data() + static_cast<std::size_t>(i) * R;
+            for (int r = 0; r < R; ++r) rates[r] += w[i] * c[r];
         }
+        const auto band = Bootstrap::Summarize(rates);
 
-        vetoFile << "eventID";
-        for (Int_t ch : sortedVetoChannels) {
-            vetoFile << ",ch" << ch;
+        std::ofstream rateOut((fs::path(dir) / "rate_bootstrap.csv").string());
+        if (!rateOut.is_open()) {
+            throw std::runtime_error("Cannot open output CSV: rate_bootstrap.csv");
         }
-        vetoFile << "\n";
-
-        for (Int_t evtID : allEventIDs) {
-            vetoFile << evtID;
+        rateOut << "replica,Rate_Real\n" << std::setprecision(17);
+        for (int r = 0; r < R; ++r) rateOut << r << "," << rates[r] << "\n";
+        rateOut.close();
 
-            const auto& channels = vetoChannels[evtID];
-            for (Int_t ch : sortedVetoChannels) {
-                auto it = channels.find(ch);
-                if (it != channels.end()) {
-                    vetoFile << "," << it->second;
-                } else {
-                    vetoFile << ",0";
-                }
-            }
-            vetoFile << "\n";
-        }
-        vetoFile.close();
+        info << std::setprecision(6);
+        info << "\n\tRate_Real_mean: " << band.mean;
+        info << "\n\tRate_Real_std: " << band.std;
+        info << "\n\tRate_Real_p16: " << band.p16;
+        info << "\n\tRate_Real_p50: " << band.p50;
+        info << "\n\tRate_Real_p84: " << band.p84;
     }
 
-    if (!sortedBottomVetoChannels.empty()) {
-        std::ofstream bottomFile(fs::path(opticDir) / "BottomVeto_channel.csv");
-        if (!bottomFile.is_open()) {
-            throw std::runtime_error("Cannot open output CSV: BottomVeto_channel.csv");
-        }
+    if (!settings.infoFile.empty()) {
+        WriteInfoBlock("Bootstrap", info.str());
+    }
+}
 
-        bottomFile << "eventID";
-        for (Int_t ch : sortedBottomVetoChannels) {
-            bottomFile << ",ch" << ch;
+// Replaces (or appends) "<blockName>:\n{ ... }" in the run's info file.
+void PostProcessing::WriteInfoBlock(const std::string& blockName, const std::string& body) const {
+    std::string text;
+    {
+        std::ifstream in(settings.infoFile);
+        if (!in.is_open()) {
+            throw std::runtime_error("Cannot open info file: " + settings.infoFile);
         }
-        bottomFile << "\n";
+        std::ostringstream ss;
+        ss << in.rdbuf();
+        text = ss.str();
+    }
 
-        for (Int_t evtID : allEventIDs) {
-            bottomFile << evtID;
+    const std::string header = blockName + ":\n{";
+    if (const auto start = text.find(header); start != std::string::npos) {
+        auto end = text.find("\n}", start);
+        end = end == std::string::npos ? text.size() : end + 2;
+        while (end < text.size() && text[end] == '\n') ++end;
+        text.erase(start, end - start);
+    }
 
-            const auto& channels = bottomVetoChannels[evtID];
-            for (Int_t ch : sortedBottomVetoChannels) {
-                auto it = channels.find(ch);
-                if (it != channels.end()) {
-                    bottomFile << "," << it->second;
-                } else {
-                    bottomFile << ",0";
-                }
-            }
-            bottomFile << "\n";
-        }
-        bottomFile.close();
+    std::ofstream out(settings.infoFile, std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("Cannot write info file: " + settings.infoFile);
     }
+    out << text << header << "\n\t" << body << "\n}\n\n";
 }
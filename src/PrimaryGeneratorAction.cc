@@ -4,15 +4,9 @@
 PrimaryGeneratorAction::PrimaryGeneratorAction(G4String fDir, const G4String& fluxType, const G4double cThreshold)
     : particleGun(new G4ParticleGun(1)),
       center(G4ThreeVector(0, 0, 0)),
-      detectorHalfSize(G4ThreeVector(0 * mm,
-                                     std::max(Sizes::Envelope::halfX, Sizes::Envelope::halfY),
-                                     Sizes::Envelope::sizeZ)),
       fluxDirection(std::move(fDir)),
       eCrystalThreshold(cThreshold) {
-    const G4ThreeVector tempVec = G4ThreeVector(0,
-                                                detectorHalfSize.y(),
-                                                detectorHalfSize.z());
-    radius = sqrt(tempVec.y() * tempVec.y() + tempVec.z() * tempVec.z()) + 5 * mm;
+    UpdateSource();
 
     std::vector<G4String> fluxDirList = {
         "isotropic", "isotropic_up", "isotropic_down", "vertical_up", "vertical_down", "horizontal"
@@ -52,6 +46,16 @@ PrimaryGeneratorAction::~PrimaryGeneratorAction() {
 }
 
 
+void PrimaryGeneratorAction::UpdateSource() {
+    detectorHalfSize = G4ThreeVector(0 * mm,
+                                     std::max(Sizes::Envelope::halfX, Sizes::Envelope::halfY),
+                                     Sizes::Envelope::sizeZ);
+    radius = std::sqrt(detectorHalfSize.y() * detectorHalfSize.y() + detectorHalfSize.z() * detectorHalfSize.z())
+             + 5 * mm;
+    sizesRevision = Sizes::revision;
+}
+
+
 void PrimaryGeneratorAction::GenerateOnSphere(G4ThreeVector& pos, G4ThreeVector& dir) const {
     G4double u = 0;
     if (fluxDirection == "isotropic") {
@@ -85,6 +89,26 @@ void PrimaryGeneratorAction::GenerateOnSphere(G4ThreeVector& pos, G4ThreeVector&
 
 
 void PrimaryGeneratorAction::GeneratePrimaries(G4Event* evt) {
+    if (sizesRevision != Sizes::revision) UpdateSource();
+
+    // Each event starts from seeds of (seed, job, runID, eventID), so the runs of one macro (and the variants
+    // of a geometry sweep) are independent; a replay run takes its runIDs and eventIDs from the list.
+    // job and runID get 16 bits each: run 65536 of a process (and job 65536) repeats the seeds of run 0.
+    // Not covered by replay: with --run-manager subevent the optical photons are tracked in sub-events
+    // seeded by the run manager, not from this stream, so the SiPM response of a replayed event differs.
+    G4int runID = G4RunManager::GetRunManager()->GetCurrentRun()->GetRunID();
+    if (!Configuration::replayEvents.empty()) {
+        const auto& [replayRun, replayEvent] = Configuration::replayEvents[evt->GetEventID()];
+        runID = replayRun;
+        evt->SetEventID(replayEvent);
+    }
+    long seeds[3];
+    Utils::DeriveSeeds(static_cast<std::uint64_t>(Configuration::seed) ^ 0xe7037ed1a0b428dbULL,
+                       static_cast<std::uint64_t>(Configuration::jobIndex) << 48 |
+                       static_cast<std::uint64_t>(runID & 0xffff) << 32 |
+                       static_cast<std::uint32_t>(evt->GetEventID()), seeds);
+    G4Random::setTheSeeds(seeds);
+
     G4ThreeVector x, v;
     if (fluxDirection == "vertical_up") {
         v = G4ThreeVector(0., 0., 1.);
@@ -129,6 +153,8 @@ void PrimaryGeneratorAction::GeneratePrimaries(G4Event* evt) {
         rec.dir = v;
         rec.pos_mm = x / mm;
         rec.t0_ns = 0.0;
+        rec.seeds[0] = seeds[0];
+        rec.seeds[1] = seeds[1];
         ea->primBuf.emplace_back(std::move(rec));
     }
 }
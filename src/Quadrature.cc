@@ -0,0 +1,223 @@
+#include "Quadrature.hh"
+
+// 15-point Kronrod abscissae (odd indices are the 7-point Gauss nodes) and weights, QUADPACK qk15.
+static constexpr std::array<double, 8> xgk = {
+    0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245, 0.000000000000000000000000000000000,
+};
+static constexpr std::array<double, 8> wgk = {
+    0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649, 0.209482141084727828012999174891714,
+};
+static constexpr std::array<double, 4> wg = {
+    0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+    0.381830050505118944950369775488975, 0.417959183673469387755102040816327,
+};
+
+static constexpr int kNodes = 15;
+
+// Nodes of [u0, u1] in log-energy, written as energies: E[0..6] left, E[7] centre, E[8..14] right.
+static void KronrodEnergies(const double u0, const double u1, double* E) {
+    const double c = 0.5 * (u0 + u1);
+    const double h = 0.5 * (u1 - u0);
+    for (int j = 0; j < 7; ++j) {
+        E[j] = std::exp(c - h * xgk[j]);
+        E[14 - j] = std::exp(c + h * xgk[j]);
+    }
+    E[7] = std::exp(c);
+}
+
+struct GKEstimate {
+    double value;
+    double error;
+};
+
+// f holds flux at the nodes; dE = E du supplies the Jacobian.
+static GKEstimate KronrodSum(const double u0, const double u1, const double* E, const double* f) {
+    const double h = 0.5 * (u1 - u0);
+    double kron = wgk[7] * E[7] * f[7];
+    double gauss = wg[3] * E[7] * f[7];
+    for (int j = 0; j < 7; ++j) {
+        const double pair = E[j] * f[j] + E[14 - j] * f[14 - j];
+        kron += wgk[j] * pair;
+        if (j % 2 == 1) gauss += wg[j / 2] * pair;
+    }
+    return {kron * h, std::fabs((kron - gauss) * h)};
+}
+
+struct Interval {
+    double u0, u1;
+    GKEstimate est;
+
+    bool operator<(const Interval& other) const { return est.error < other.est.error; }
+};
+
+static bool WithinTolerance(const double value, const double error, const QuadOptions& opt) {
+    return error <= std::max(opt.absTol, opt.relTol * std::fabs(value));
+}
+
+// Adaptive refinement of [u0, u1] starting from an already computed estimate.
+static QuadResult Refine(const Spectrum& spectrum, const double u0, const double u1,
+                         const GKEstimate& first, const QuadOptions& opt) {
+    QuadResult res;
+    res.value = first.value;
+    res.error = first.error;
+
+    std::priority_queue<Interval> work;
+    work.push({u0, u1, first});
+
+    std::array<double, 2 * kNodes> E{};
+    std::array<double, 2 * kNodes> f{};
+    while (!WithinTolerance(res.value, res.error, opt) && static_cast<int>(work.size()) < opt.maxIntervals) {
+        const Interval worst = work.top();
+        work.pop();
+
+        const double mid = 0.5 * (worst.u0 + worst.u1);
+        KronrodEnergies(worst.u0, mid, E.data());
+        KronrodEnergies(mid, worst.u1, E.data() + kNodes);
+        spectrum.Evaluate(E.data(), f.data(), E.size());
+        res.evaluations += 2 * kNodes;
+
+        const GKEstimate left = KronrodSum(worst.u0, mid, E.data(), f.data());
+        const GKEstimate right = KronrodSum(mid, worst.u1, E.data() + kNodes, f.data() + kNodes);
+
+        res.value += left.value + right.value - worst.est.value;
+        res.error += left.error + right.error - worst.est.error;
+        work.push({worst.u0, mid, left});
+        work.push({mid, worst.u1, right});
+    }
+
+    // Re-sum to drop the rounding accumulated by the running updates.
+    res.value = 0.0;
+    res.error = 0.0;
+    while (!work.empty()) {
+        res.value += work.top().est.value;
+        res.error += work.top().est.error;
+        work.pop();
+    }
+    res.converged = WithinTolerance(res.value, res.error, opt);
+    return res;
+}
+
+QuadResult integrateLogGK(const Spectrum& spectrum, const double a, const double b, const QuadOptions& opt) {
+    if (a == b) return {0.0, 0.0, 0, true};
+    if (a <= 0.0 || b <= 0.0) {
+        throw std::runtime_error("integrateLogGK: limits must be positive");
+    }
+    const double sign = b < a ? -1.0 : 1.0;
+    const double u0 = std::log(std::min(a, b));
+    const double u1 = std::log(std::max(a, b));
+
+    std::array<double, kNodes> E{};
+    std::array<double, kNodes> f{};
+    KronrodEnergies(u0, u1, E.data());
+    spectrum.Evaluate(E.data(), f.data(), kNodes);
+
+    QuadResult res = Refine(spectrum, u0, u1, KronrodSum(u0, u1, E.data(), f.data()), opt);
+    res.evaluations += kNodes;
+    res.value *= sign;
+    return res;
+}
+
+// One Kronrod rule per bin over the whole grid, then adaptive refinement of the bins that need it.
+// Returned values are in model units; the caller applies the spectrum's scales.
+static std::vector<QuadResult> BinRules(const Spectrum& spectrum, const std::vector<double>& edges,
+                                        const std::vector<double>& u, const std::vector<double>& E,
+                                        const QuadOptions& opt) {
+    const std::size_t nBins = edges.size() - 1;
+    std::vector<double> f(E.size());
+    spectrum.Evaluate(E.data(), f.data(), E.size());
+
+    std::vector<QuadResult> bins(nBins);
+    for (std::size_t i = 0; i < nBins; ++i) {
+        const double* Ei = E.data() + i * kNodes;
+        const double* fi = f.data() + i * kNodes;
+        const GKEstimate est = KronrodSum(u[i], u[i + 1], Ei, fi);
+        if (WithinTolerance(est.value, est.error, opt)) {
+            bins[i] = {est.value, est.error, kNodes, true};
+        } else {
+            bins[i] = Refine(spectrum, u[i], u[i + 1], est, opt);
+            bins[i].evaluations += kNodes;
+        }
+    }
+    return bins;
+}
+
+static void CheckEdges(const std::vector<double>& edges) {
+    if (edges.size() < 2) throw std::runtime_error("Quadrature: need at least one bin");
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+        if (edges[i] <= 0.0 || (i > 0 && edges[i] <= edges[i - 1])) {
+            throw std::runtime_error("Quadrature: bin edges must be positive and increasing");
+        }
+    }
+}
+
+std::vector<QuadResult> foldSpectra(const std::vector<const Spectrum*>& spectra,
+                                    const std::vector<double>& edges,
+                                    const std::vector<double>& Aeff,
+                                    const QuadOptions& opt) {
+    CheckEdges(edges);
+    const std::size_t nBins = edges.size() - 1;
+    if (Aeff.size() != nBins) throw std::runtime_error("foldSpectra: Aeff.size() != number of bins");
+
+    std::vector<QuadResult> out;
+    out.reserve(spectra.size());
+
+    // Node grid is rebuilt only when the energy scale changes between spectra.
+    double gridScale = 0.0;
+    std::vector<double> u(nBins + 1);
+    std::vector<double> E(nBins * kNodes);
+
+    for (const Spectrum* spectrum : spectra) {
+        const double es = spectrum->EnergyScale();
+        if (es != gridScale) {
+            for (std::size_t i = 0; i <= nBins; ++i) u[i] = std::log(edges[i] * es);
+            for (std::size_t i = 0; i < nBins; ++i) KronrodEnergies(u[i], u[i + 1], E.data() + i * kNodes);
+            gridScale = es;
+        }
+
+        const auto bins = BinRules(*spectrum, edges, u, E, opt);
+        const double scale = spectrum->AreaScale();
+
+        QuadResult total;
+        total.converged = true;
+        for (std::size_t i = 0; i < nBins; ++i) {
+            total.value += bins[i].value * scale * Aeff[i];
+            total.error += bins[i].error * scale * std::fabs(Aeff[i]);
+            total.evaluations += bins[i].evaluations;
+            total.converged = total.converged && bins[i].converged;
+        }
+        out.push_back(total);
+    }
+    return out;
+}
+
+std::vector<double> binIntegrals(const Spectrum& spectrum,
+                                 const std::vector<double>& edges,
+                                 const QuadOptions& opt,
+                                 double* error) {
+    CheckEdges(edges);
+    const std::size_t nBins = edges.size() - 1;
+    const double es = spectrum.EnergyScale();
+
+    std::vector<double> u(nBins + 1);
+    std::vector<double> E(nBins * kNodes);
+    for (std::size_t i = 0; i <= nBins; ++i) u[i] = std::log(edges[i] * es);
+    for (std::size_t i = 0; i < nBins; ++i) KronrodEnergies(u[i], u[i + 1], E.data() + i * kNodes);
+
+    const auto bins = BinRules(spectrum, edges, u, E, opt);
+    const double scale = spectrum.AreaScale();
+
+    std::vector<double> w(nBins);
+    double err = 0.0;
+    for (std::size_t i = 0; i < nBins; ++i) {
+        w[i] = bins[i].value * scale;
+        err += bins[i].error * scale;
+    }
+    if (error) *error = err;
+    return w;
+}
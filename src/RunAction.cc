@@ -1,4 +1,5 @@
 #include "RunAction.hh"
+#include "EventAction.hh"
 
 using namespace Configuration;
 
@@ -41,6 +42,7 @@ void RunAction::BookAccumulables() {
 
     mgr->Register(crystalOnlyOpt);
     mgr->Register(crystalAndVetoOpt);
+    mgr->Register(steps);
 
     genCounts.clear();
     trigCounts.clear();
@@ -59,6 +61,13 @@ void RunAction::BookAccumulables() {
         genCounts.emplace_back(0.0);
         mgr->Register(genCounts.back());
     }
+
+    if (thresholdScan) {
+        scan = std::make_unique<ThresholdScan>(scanCrystalThresholds, scanVetoThresholds,
+                                               scanOptCrystalThresholds, scanOptVetoThresholds,
+                                               scanOptBottomThresholds, nBins, useOptics);
+        scan->Register(mgr);
+    }
 }
 
 RunAction::~RunAction() {
@@ -66,6 +75,7 @@ RunAction::~RunAction() {
 }
 
 void RunAction::BeginOfRunAction(const G4Run*) {
+    analysisManager->SetFileName(outputFile);
     analysisManager->Open();
     auto* mgr = G4AccumulableManager::Instance();
     mgr->Reset();
@@ -74,12 +84,32 @@ void RunAction::BeginOfRunAction(const G4Run*) {
     totalsOpt = {};
     std::fill(effArea.begin(), effArea.end(), 0.0);
     std::fill(effAreaOpt.begin(), effAreaOpt.end(), 0.0);
+
+    stepCount = 0;
+    if (benchmark) timer.Start();
 }
 
-void RunAction::EndOfRunAction(const G4Run*) {
+void RunAction::EndOfRunAction(const G4Run* run) {
+#ifdef NADYA_SUBEVENT_PARALLEL
+    // Every sub-event has been merged by now; the counters they feed must be filled before the merge below.
+    if (eventAction) eventAction->FinishDeferredEvents();
+#endif
     auto* mgr = G4AccumulableManager::Instance();
+    steps += static_cast<G4double>(stepCount);
     mgr->Merge();
     if (G4Threading::IsMasterThread()) {
+        if (benchmark) {
+            timer.Stop();
+            const G4double seconds = timer.GetRealElapsed();
+            const G4int events = run ? run->GetNumberOfEvent() : 0;
+            G4cout << "Benchmark (" << runManagerType << " x" << G4RunManager::GetRunManager()->GetNumberOfThreads()
+                   << ", " << fiberPlacement << " fibers, " << emPhysics << " EM, field "
+                   << MagneticField::Describe() << "): "
+                   << static_cast<G4long>(steps.GetValue()) << " steps, " << events << " events in "
+                   << seconds << " s -> "
+                   << (seconds > 0.0 ? steps.GetValue() / seconds : 0.0) << " steps/s, "
+                   << (seconds > 0.0 ? events / seconds : 0.0) << " events/s" << G4endl;
+        }
         totals.crystalAndVeto = crystalAndVeto.GetValue();
         totals.crystalOnly = crystalOnly.GetValue();
         totalsOpt.crystalAndVeto = crystalAndVetoOpt.GetValue();
@@ -87,6 +117,13 @@ void RunAction::EndOfRunAction(const G4Run*) {
         if (EminMeV < EmaxMeV) {
             FillDerivedHists();
         }
+        if (scan) {
+            std::vector<G4double> gen(nBins, 0.0);
+            if (EminMeV < EmaxMeV) {
+                for (int i = 0; i < nBins; ++i) gen[i] = genCounts[i].GetValue();
+            }
+            scan->Finalize(gen, area);
+        }
     }
 
     analysisManager->Close();
@@ -160,6 +197,12 @@ void RunAction::AddTriggeredCrystalOnlyOpt(double E_MeV) {
     }
 }
 
+void RunAction::AddScanEvent(ScanEvent ev, const double primaryE_MeV) {
+    if (!scan) return;
+    ev.energyBin = primaryE_MeV > 0.0 && EminMeV < EmaxMeV ? FindBinLog(primaryE_MeV) : -1;
+    scan->Fill(ev);
+}
+
 void RunAction::FillDerivedHists() {
     for (int i = 0; i < nBins; ++i) {
         const double nGen = genCounts[i].GetValue();
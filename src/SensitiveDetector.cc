@@ -30,12 +30,17 @@ G4bool SensitiveDetector::ProcessHits(G4Step *step, G4TouchableHistory *) {
     }
 
     const G4VTouchable *touch = step->GetPreStepPoint()->GetTouchable();
-    const int volumeID = touch->GetVolume()->GetCopyNo();
+    const int volumeID = VolumeID(touch);
 
     const G4double t = step->GetPreStepPoint()->GetGlobalTime();
 
     SDHit *hit = FindOrCreateHit(volumeID);
 
+    if (detName == "Calorimeter" && hit->crystalX < 0) {
+        hit->crystalX = volumeID % Sizes::Calorimeter::rowsX;
+        hit->crystalY = volumeID / Sizes::Calorimeter::rowsX;
+    }
+
     // Optionally decode TOF fiber indices (plane/module/layer/fiberIndex)
     // for CoordSD (X plane) and FiberSD (Y plane).
     if (detName == "TOFFibers" || detName == "Fiber") {
@@ -46,16 +51,8 @@ G4bool SensitiveDetector::ProcessHits(G4Step *step, G4TouchableHistory *) {
             // Determine which plane this SD corresponds to: 0 = X, 1 = Y.
             const G4int plane = (detName == "TOFFibers") ? 0 : 1;
 
-            // Recompute rows per layer exactly as in Detector::ConstructTOFFibers.
-            const G4double stepFiber = 2.0 * TOFFibers::fiberRadius + TOFFibers::fiberStripGap;
-            G4int rows = 0;
-            if (plane == 0) {
-                const G4int maxRowsX = static_cast<G4int>(std::floor(TOFFibers::sizeX / stepFiber));
-                rows = std::max(0, std::min(TOFFibers::fiberRowsX, maxRowsX));
-            } else {
-                const G4int maxRowsY = static_cast<G4int>(std::floor(TOFFibers::sizeY / stepFiber));
-                rows = std::max(0, std::min(TOFFibers::fiberRowsY, maxRowsY));
-            }
+            // Rows per layer as placed by Detector::ConstructTOFFibers.
+            const G4int rows = (plane == 0) ? TOFFibers::usedRowsX : TOFFibers::usedRowsY;
 
             G4int layer = -1;
             G4int fiberIndex = -1;
@@ -88,6 +85,18 @@ G4bool SensitiveDetector::ProcessHits(G4Step *step, G4TouchableHistory *) {
     return true;
 }
 
+// Parameterised crystals carry the channel themselves; parameterised fiber planes place the core
+// once inside each cladding copy.
+G4int SensitiveDetector::VolumeID(const G4VTouchable *touch) {
+    if (touch->GetVolume()->IsParameterised()) {
+        return touch->GetReplicaNumber(0);
+    }
+    if (touch->GetHistoryDepth() > 0 && touch->GetVolume(1)->IsParameterised()) {
+        return touch->GetReplicaNumber(1);
+    }
+    return touch->GetVolume()->GetCopyNo();
+}
+
 SDHit *SensitiveDetector::FindOrCreateHit(G4int volumeID) {
     auto it = indexByVol.find(volumeID);
     if (it != indexByVol.end()) {
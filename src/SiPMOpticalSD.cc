@@ -10,6 +10,23 @@ void SiPMOpticalSD::Initialize(G4HCofThisEvent*) {
     perChBottom.clear();
 }
 
+void SiPMOpticalSD::EndOfEvent(G4HCofThisEvent*) {
+    if (!InSubEvent()) return;
+
+    auto* info = new SiPMSubEventInfo;
+    info->npeCrystal = npeCrystal;
+    info->npeVeto = npeVeto;
+    info->npeBottom = npeBottom;
+    info->perChCrystal = std::move(perChCrystal);
+    info->perChVeto = std::move(perChVeto);
+    info->perChBottom = std::move(perChBottom);
+    if (auto* ea = dynamic_cast<EventAction*>(G4EventManager::GetEventManager()->GetUserEventAction())) {
+        info->photons = std::move(ea->photonBuf);
+        ea->photonBuf.clear();
+    }
+    G4EventManager::GetEventManager()->GetNonconstCurrentEvent()->SetUserInformation(info);
+}
+
 G4OpBoundaryProcess* SiPMOpticalSD::GetBoundaryProcess() {
     if (boundary) return boundary;
     auto* pm = G4OpticalPhoton::OpticalPhoton()->GetProcessManager();
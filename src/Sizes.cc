@@ -0,0 +1,177 @@
+#include "Sizes.hh"
+
+namespace Sizes {
+
+namespace {
+struct Key {
+    const char* name;
+    G4double* value;
+    G4int* count;
+};
+
+const Key keys[] = {
+    {"Instrument.sizeX", &Instrument::sizeX, nullptr},
+    {"Instrument.sizeY", &Instrument::sizeY, nullptr},
+    {"Instrument.sizeZ", &Instrument::sizeZ, nullptr},
+    {"Instrument.bottomZ", &Instrument::bottomZ, nullptr},
+
+    {"Stack.caloBottomZ", &Stack::caloBottomZ, nullptr},
+    {"Stack.gapPostCaloACToCalo", &Stack::gapPostCaloACToCalo, nullptr},
+    {"Stack.gapCaloToTrigger2", &Stack::gapCaloToTrigger2, nullptr},
+    {"Stack.gapTrigger2ToFiber", &Stack::gapTrigger2ToFiber, nullptr},
+    {"Stack.gapFiberToTrigger1", &Stack::gapFiberToTrigger1, nullptr},
+    {"Stack.gapInsideTriggerPair", &Stack::gapInsideTriggerPair, nullptr},
+
+    {"PostCaloAC.outerHalfX", &PostCaloAC::outerHalfX, nullptr},
+    {"PostCaloAC.outerHalfY", &PostCaloAC::outerHalfY, nullptr},
+    {"PostCaloAC.thickness", &PostCaloAC::thickness, nullptr},
+
+    {"Calorimeter.crystalWidth", &Calorimeter::crystalWidth, nullptr},
+    {"Calorimeter.crystalLength", &Calorimeter::crystalLength, nullptr},
+    {"Calorimeter.crystalHeight", &Calorimeter::crystalHeight, nullptr},
+    {"Calorimeter.rowsX", nullptr, &Calorimeter::rowsX},
+    {"Calorimeter.rowsY", nullptr, &Calorimeter::rowsY},
+    {"Calorimeter.gap", &Calorimeter::gap, nullptr},
+
+    {"TOFFibers.sizeX", &TOFFibers::sizeX, nullptr},
+    {"TOFFibers.sizeY", &TOFFibers::sizeY, nullptr},
+    {"TOFFibers.fiberRowsX", nullptr, &TOFFibers::fiberRowsX},
+    {"TOFFibers.fiberRowsY", nullptr, &TOFFibers::fiberRowsY},
+    {"TOFFibers.fiberRadius", &TOFFibers::fiberRadius, nullptr},
+    {"TOFFibers.fiberCladThickness", &TOFFibers::fiberCladThickness, nullptr},
+    {"TOFFibers.fiberStripGap", &TOFFibers::fiberStripGap, nullptr},
+    {"TOFFibers.fiberLayersPerPlane", nullptr, &TOFFibers::fiberLayersPerPlane},
+    {"TOFFibers.fiberModuleCount", nullptr, &TOFFibers::fiberModuleCount},
+    {"TOFFibers.fiberModuleGap", &TOFFibers::fiberModuleGap, nullptr},
+
+    {"Trigger.segmentCount", nullptr, &Trigger::segmentCount},
+    {"Trigger.stripWidth", &Trigger::stripWidth, nullptr},
+    {"Trigger.panelThickness", &Trigger::panelThickness, nullptr},
+
+    {"VetoAC.outerHalfX", &VetoAC::outerHalfX, nullptr},
+    {"VetoAC.outerHalfY", &VetoAC::outerHalfY, nullptr},
+    {"VetoAC.thickness", &VetoAC::thickness, nullptr},
+
+    {"Envelope.marginXY", &Envelope::marginXY, nullptr},
+    {"Envelope.marginZ", &Envelope::marginZ, nullptr},
+};
+
+void Require(const bool ok, const std::string& what) {
+    if (!ok) throw std::runtime_error("Bad geometry description: " + what);
+}
+
+// Built-in values of every key, so that each loaded description starts from the defaults.
+struct Defaults {
+    std::vector<G4double> values;
+
+    Defaults() {
+        for (const auto& k : keys) values.push_back(k.value ? *k.value : static_cast<G4double>(*k.count));
+    }
+
+    void Restore() const {
+        for (std::size_t i = 0; i < std::size(keys); ++i) {
+            if (keys[i].value) *keys[i].value = values[i];
+            else *keys[i].count = static_cast<G4int>(values[i]);
+        }
+    }
+};
+}
+
+void Load(const std::string& path) {
+    static const Defaults defaults;
+    defaults.Restore();
+
+    for (const auto& [name, v] : Utils::ReadConstFile(path)) {
+        const Key* key = nullptr;
+        for (const auto& k : keys) {
+            if (name == k.name) key = &k;
+        }
+        if (!key) throw std::runtime_error("Unknown geometry key '" + name + "' in " + path);
+
+        if (key->value) {
+            *key->value = v;
+        } else {
+            if (v != std::floor(v)) throw std::runtime_error("Geometry key '" + name + "' must be an integer");
+            *key->count = static_cast<G4int>(v);
+        }
+    }
+    Recompute();
+}
+
+void Recompute() {
+    Require(Calorimeter::rowsX > 0 && Calorimeter::rowsY > 0, "calorimeter needs at least one crystal per row");
+    Require(TOFFibers::fiberLayersPerPlane > 0 && TOFFibers::fiberModuleCount > 0, "fiber layer/module count");
+    Require(Trigger::segmentCount > 0, "trigger segment count");
+    Require(PostCaloAC::thickness < std::min(PostCaloAC::outerHalfX, PostCaloAC::outerHalfY), "PostCaloAC thickness");
+    Require(VetoAC::thickness < std::min(VetoAC::outerHalfX, VetoAC::outerHalfY), "VetoAC thickness");
+    Require(TOFFibers::fiberCladThickness < TOFFibers::fiberRadius, "fiber cladding thicker than the fiber");
+
+    Instrument::halfX = Instrument::sizeX / 2.0;
+    Instrument::halfY = Instrument::sizeY / 2.0;
+    Instrument::halfZ = Instrument::sizeZ / 2.0;
+    Instrument::topZ = Instrument::bottomZ + Instrument::sizeZ;
+
+    PostCaloAC::innerHalfX = PostCaloAC::outerHalfX - PostCaloAC::thickness;
+    PostCaloAC::innerHalfY = PostCaloAC::outerHalfY - PostCaloAC::thickness;
+    PostCaloAC::bottomZ = Stack::caloBottomZ;
+    PostCaloAC::topZ = PostCaloAC::bottomZ + PostCaloAC::thickness;
+
+    Calorimeter::bottomZ = PostCaloAC::topZ + Stack::gapPostCaloACToCalo;
+    Calorimeter::topZ = Calorimeter::bottomZ + Calorimeter::crystalHeight;
+
+    TOFFibers::halfX = TOFFibers::sizeX / 2.0;
+    TOFFibers::halfY = TOFFibers::sizeY / 2.0;
+    TOFFibers::layerCenterDist = TOFFibers::fiberRadius * 2.0 + TOFFibers::fiberStripGap;
+    TOFFibers::planeThickness = 2.0 * TOFFibers::fiberRadius
+                                + (TOFFibers::fiberLayersPerPlane - 1) * TOFFibers::layerCenterDist;
+    TOFFibers::fiberModuleThickness = 2.0 * TOFFibers::planeThickness;
+    TOFFibers::thickness = TOFFibers::fiberModuleCount * TOFFibers::fiberModuleThickness
+                           + (TOFFibers::fiberModuleCount - 1) * TOFFibers::fiberModuleGap;
+    TOFFibers::step = 2.0 * TOFFibers::fiberRadius + TOFFibers::fiberStripGap;
+    TOFFibers::usedRowsX = std::max(0, std::min(TOFFibers::fiberRowsX,
+                                                static_cast<G4int>(std::floor(TOFFibers::sizeX / TOFFibers::step))));
+    TOFFibers::usedRowsY = std::max(0, std::min(TOFFibers::fiberRowsY,
+                                                static_cast<G4int>(std::floor(TOFFibers::sizeY / TOFFibers::step))));
+
+    Trigger::panelSizeX = Trigger::segmentCount * Trigger::stripWidth;
+    Trigger::panelSizeY = Trigger::segmentCount * Trigger::stripWidth;
+    Trigger::halfX = Trigger::panelSizeX / 2.0;
+    Trigger::halfY = Trigger::panelSizeY / 2.0;
+
+    Trigger::pair2LowerBottomZ = Calorimeter::topZ + Stack::gapCaloToTrigger2;
+    Trigger::pair2LowerTopZ = Trigger::pair2LowerBottomZ + Trigger::panelThickness;
+    Trigger::pair2UpperBottomZ = Trigger::pair2LowerTopZ + Stack::gapInsideTriggerPair;
+    Trigger::pair2UpperTopZ = Trigger::pair2UpperBottomZ + Trigger::panelThickness;
+
+    Trigger::fibersBottomZ = Trigger::pair2UpperTopZ + Stack::gapTrigger2ToFiber;
+    Trigger::fibersTopZ = Trigger::fibersBottomZ + TOFFibers::thickness;
+
+    Trigger::pair1LowerBottomZ = Trigger::fibersTopZ + Stack::gapFiberToTrigger1;
+    Trigger::pair1LowerTopZ = Trigger::pair1LowerBottomZ + Trigger::panelThickness;
+    Trigger::pair1UpperBottomZ = Trigger::pair1LowerTopZ + Stack::gapInsideTriggerPair;
+    Trigger::pair1UpperTopZ = Trigger::pair1UpperBottomZ + Trigger::panelThickness;
+
+    TOFFibers::bottomZ = Trigger::fibersBottomZ;
+    TOFFibers::topZ = Trigger::fibersTopZ;
+
+    VetoAC::innerHalfX = VetoAC::outerHalfX - VetoAC::thickness;
+    VetoAC::innerHalfY = VetoAC::outerHalfY - VetoAC::thickness;
+    VetoAC::bottomZ = Trigger::pair2LowerBottomZ;
+    VetoAC::topZ = Trigger::pair1UpperTopZ;
+
+    Envelope::halfX = std::max(50.0 * mm, VetoAC::outerHalfX + Envelope::marginXY);
+    Envelope::halfY = std::max(50.0 * mm, VetoAC::outerHalfY + Envelope::marginXY);
+    Envelope::bottomZ = PostCaloAC::bottomZ - Envelope::marginZ;
+    Envelope::topZ = std::max(Trigger::pair1UpperTopZ, VetoAC::topZ) + Envelope::marginZ;
+    Envelope::sizeZ = Envelope::topZ - Envelope::bottomZ;
+    Envelope::halfZ = Envelope::sizeZ / 2.0;
+
+    CubeInner::halfX = Envelope::halfX;
+    CubeInner::halfY = Envelope::halfY;
+    CubeInner::bottomZ = Envelope::bottomZ;
+    CubeInner::topZ = Envelope::topZ;
+
+    ++revision;
+}
+
+}
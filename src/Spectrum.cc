@@ -0,0 +1,315 @@
+#include "Spectrum.hh"
+
+double Spectrum::Evaluate(const double E) const {
+    double out;
+    Evaluate(&E, &out, 1);
+    return out;
+}
+
+std::vector<double> Spectrum::Evaluate(const std::vector<double>& E) const {
+    std::vector<double> out(E.size());
+    Evaluate(E.data(), out.data(), E.size());
+    return out;
+}
+
+// --- PLAW / COMP ---
+PowerLawSpectrum::PowerLawSpectrum(const double A, const double alpha, const double E_piv)
+    : A(A), alpha(alpha), invEpiv(1.0 / E_piv) {
+}
+
+void PowerLawSpectrum::Evaluate(const double* E, double* out, const std::size_t n) const {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = A * std::exp(-alpha * std::log(E[i] * invEpiv));
+    }
+}
+
+CompSpectrum::CompSpectrum(const double A, const double alpha, const double E_piv, const double E_peak)
+    : A(A), alpha(alpha), invEpiv(1.0 / E_piv), cutoff((alpha - 2.0) / E_peak) {
+}
+
+void CompSpectrum::Evaluate(const double* E, double* out, const std::size_t n) const {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = A * std::exp(-alpha * std::log(E[i] * invEpiv) + cutoff * E[i]);
+    }
+}
+
+// --- SEP ---
+static std::vector<double> readSepRow(const int year, const int order, const std::string& csvPath) {
+    std::ifstream in(csvPath);
+    if (!in.is_open()) {
+        throw std::runtime_error("SEP: cannot open coefficients CSV: " + csvPath);
+    }
+    std::string line;
+    std::getline(in, line);
+
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        std::stringstream ss(line);
+        std::string cell;
+        std::vector<double> cols;
+        while (std::getline(ss, cell, ',')) {
+            try {
+                cols.push_back(std::stod(cell));
+            }
+            catch (...) {
+                cols.push_back(std::numeric_limits<double>::quiet_NaN());
+            }
+        }
+        if (cols.size() < 3) continue;
+
+        const int y = static_cast<int>(cols[0]);
+        const int k = static_cast<int>(cols[1]);
+        if (y == year && k == order) {
+            cols.pop_back();
+            return cols;
+        }
+    }
+    throw std::runtime_error("SEP: row not found for year=" + std::to_string(year) +
+                             " order=" + std::to_string(order));
+}
+
+SEPSpectrum::SEPSpectrum(const int year, const int order, const std::string& csvPath) {
+    const std::vector<double> row = readSepRow(year, order, csvPath);
+    // Columns: year, order, c0 .. c_order
+    if (row.size() < 4) return;
+    if (row.size() < static_cast<std::size_t>(order) + 3) {
+        throw std::runtime_error("SEP: too few coefficients for order=" + std::to_string(order));
+    }
+    coeffs.assign(row.begin() + 2, row.begin() + order + 3);
+}
+
+void SEPSpectrum::Evaluate(const double* E, double* out, const std::size_t n) const {
+    if (coeffs.empty()) {
+        std::fill(out, out + n, 0.0);
+        return;
+    }
+    const double* c = coeffs.data();
+    const std::size_t last = coeffs.size() - 1;
+    constexpr double ln10 = 2.302585092994046;
+    for (std::size_t i = 0; i < n; ++i) {
+        const double x = std::log10(E[i]);
+        double poly = c[last];
+        for (std::size_t k = last; k-- > 0;) {
+            poly = poly * x + c[k];
+        }
+        out[i] = std::exp(poly * ln10);
+    }
+}
+
+// --- Table ---
+TableSpectrum::TableSpectrum(const std::string& csvPath) {
+    std::ifstream in(csvPath);
+    if (!in.is_open()) {
+        throw std::runtime_error("Cannot open CSV file: " + csvPath);
+    }
+
+    std::vector<std::pair<double, double>> rows;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+
+        std::stringstream ss(line);
+        std::string energy_str, flux_str;
+        std::getline(ss, energy_str, ',');
+        std::getline(ss, flux_str, ',');
+
+        try {
+            rows.emplace_back(std::stod(energy_str), std::stod(flux_str));
+        }
+        catch (...) {
+        }
+    }
+
+    if (rows.empty()) {
+        throw std::runtime_error("No valid data found in the CSV.");
+    }
+
+    std::stable_sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+
+    constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+    for (const auto& [e, f] : rows) {
+        energies.push_back(e);
+        fluxes.push_back(f);
+        logE.push_back(e > 0.0 ? std::log(e) : nan);
+        logF.push_back(f > 0.0 ? std::log(f) : nan);
+    }
+}
+
+double TableSpectrum::At(const double E) const {
+    const std::size_t n = energies.size();
+    std::size_t i = std::upper_bound(energies.begin(), energies.end(), E) - energies.begin();
+
+    if (i == n) {
+        if (std::abs(energies.back() - E) < 1e-6) return fluxes.back();
+        throw std::runtime_error("Energy is out of range in the CSV file.");
+    }
+    if (i > 0 && std::abs(energies[i - 1] - E) < 1e-6) return fluxes[i - 1];
+    if (std::abs(energies[i] - E) < 1e-6) return fluxes[i];
+    if (n < 2) throw std::runtime_error("Energy is out of range in the CSV file.");
+    if (i == 0) i = 1;  // below the first node: extend the first segment
+
+    const double E1 = energies[i - 1];
+    const double E2 = energies[i];
+    if (E2 == E1) return fluxes[i];
+
+    if (E > 0.0 && !std::isnan(logE[i - 1]) && !std::isnan(logF[i - 1]) && !std::isnan(logF[i])) {
+        const double t = (std::log(E) - logE[i - 1]) / (logE[i] - logE[i - 1]);
+        return std::exp(logF[i - 1] + t * (logF[i] - logF[i - 1]));
+    }
+    return fluxes[i - 1] + (fluxes[i] - fluxes[i - 1]) * (E - E1) / (E2 - E1);
+}
+
+void TableSpectrum::Evaluate(const double* E, double* out, const std::size_t n) const {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = At(E[i]);
+    }
+}
+
+// --- Uniform ---
+UniformSpectrum::UniformSpectrum(const double E_min, const double E_max)
+    : invLogRange(1.0 / std::log(E_max / E_min)) {
+}
+
+void UniformSpectrum::Evaluate(const double* E, double* out, const std::size_t n) const {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = invLogRange / E[i];
+    }
+}
+
+// --- Galactic ---
+// Local interstellar spectra, E in GeV.
+static double J_Proton(const double E) {
+    constexpr double mp = 0.938272;
+    const double p98 = std::pow(0.7, 0.98);
+
+    const double ETot = E + mp;
+    double beta_sq = 1.0 - mp * mp / (ETot * ETot);
+    if (beta_sq <= 0.0) beta_sq = 1e-12;
+
+    double term1 = 2620.0 / beta_sq * std::pow(E, 1.1);
+    term1 *= std::pow((std::pow(E, 0.98) + p98) / (1.0 + p98), -4.0);
+
+    const double term2 = 30.0 * E * E * std::pow((E + 8.0) / 9.0, -12.0);
+
+    return term1 + term2;
+}
+
+static double J_Electron(const double E) {
+    constexpr double me = 0.000511;
+
+    const double ETot = E + me;
+    double beta_sq = 1.0 - me * me / (ETot * ETot);
+    if (beta_sq <= 0) beta_sq = 1e-6;
+
+    double term1 = 255.0 / beta_sq / E;
+    term1 *= std::pow((E + 0.63) / 1.63, -2.43);
+
+    const double term2 = 6.4 * E * E * std::pow((E + 15.0) / 16.0, -26.0);
+
+    return term1 + term2;
+}
+
+static double J_Positron(const double E) {
+    constexpr double me = 0.000511;
+    const double p11 = std::pow(0.2, 1.1);
+
+    const double ETot = E + me;
+    double beta = std::sqrt(1.0 - me * me / (ETot * ETot));
+    if (beta <= 0) beta = 1e-6;
+
+    double term1 = 25.0 / (beta * beta) * std::pow(E, 0.1);
+    term1 *= std::pow((std::pow(E, 1.1) + p11) / (1.0 + p11), -3.31);
+
+    const double term2 = 23.0 * std::sqrt(E) * std::pow((E + 2.2) / 3.2, -9.5);
+
+    return term1 + term2;
+}
+
+static double J_Alpha(const double E) {
+    constexpr double malpha = 3.727379;
+    const double p97 = std::pow(0.58, 0.97);
+
+    const double ETot = E + malpha;
+    double beta_sq = 1.0 - malpha * malpha / (ETot * ETot);
+    if (beta_sq <= 0) beta_sq = 1e-6;
+
+    double term1 = 163.4 / beta_sq * std::pow(E, 1.1);
+    term1 *= std::pow((std::pow(E, 0.97) + p97) / (1.0 + p97), -4.0);
+
+    return term1;
+}
+
+// Force-field approximation; the particle is fixed per call so the loop has no dispatch.
+template <class LIS>
+static void ForceField(const double* E, double* out, const std::size_t n,
+                       const double phiGV, const double mass, LIS lis) {
+    for (std::size_t i = 0; i < n; ++i) {
+        const double ELis = E[i] + phiGV;
+        const double num = E[i] * (E[i] + 2.0 * mass);
+        const double den = ELis * (ELis + 2.0 * mass);
+        out[i] = ELis > 0.0 && den > 0.0 ? num / den * lis(ELis) : 0.0;
+    }
+}
+
+GalacticSpectrum::GalacticSpectrum(const double phiMV, const std::string& name) {
+    energyScale = 1.0 / 1000.0;
+    areaScale = 1.0 / 10000.0;
+
+    if (name == "proton") {
+        particle = Particle::Proton;
+        mass = 0.938272;
+    } else if (name == "e-") {
+        particle = Particle::Electron;
+        mass = 0.000511;
+    } else if (name == "e+") {
+        particle = Particle::Positron;
+        mass = 0.000511;
+    } else if (name == "alpha") {
+        particle = Particle::Alpha;
+        mass = 3.727379;
+    } else {
+        particle = Particle::Unknown;
+    }
+    const int Z = particle == Particle::Alpha ? 2 : 1;
+    phiGV = phiMV * 1e-3 * Z;
+}
+
+void GalacticSpectrum::Evaluate(const double* E, double* out, const std::size_t n) const {
+    switch (particle) {
+    case Particle::Proton:
+        ForceField(E, out, n, phiGV, mass, J_Proton);
+        break;
+    case Particle::Electron:
+        ForceField(E, out, n, phiGV, mass, J_Electron);
+        break;
+    case Particle::Positron:
+        ForceField(E, out, n, phiGV, mass, J_Positron);
+        break;
+    case Particle::Alpha:
+        ForceField(E, out, n, phiGV, mass, J_Alpha);
+        break;
+    default:
+        std::fill(out, out + n, 0.0);
+    }
+}
+
+std::unique_ptr<Spectrum> MakeSpectrum(const FluxType type, const FluxParams& p, const EnergyRange& eRange) {
+    switch (type) {
+    case FluxType::PLAW:
+        return std::make_unique<PowerLawSpectrum>(p.A, p.alpha, p.E_piv);
+    case FluxType::COMP:
+        return std::make_unique<CompSpectrum>(p.A, p.alpha, p.E_piv, p.E_peak);
+    case FluxType::SEP:
+        return std::make_unique<SEPSpectrum>(p.sep_year, p.sep_order, p.sep_csv_path);
+    case FluxType::TABLE:
+        return std::make_unique<TableSpectrum>(p.table_path);
+    case FluxType::UNIFORM:
+        return std::make_unique<UniformSpectrum>(eRange.Emin, eRange.Emax);
+    case FluxType::GALACTIC:
+        return std::make_unique<GalacticSpectrum>(p.phiMV, p.particle);
+    default:
+        throw std::runtime_error("Unknown flux type");
+    }
+}
@@ -0,0 +1,10 @@
+#include "StackingAction.hh"
+
+#ifdef NADYA_SUBEVENT_PARALLEL
+G4ClassificationOfNewTrack StackingAction::ClassifyNewTrack(const G4Track* track) {
+    if (track->GetParentID() > 0 && track->GetDefinition() == G4OpticalPhoton::Definition()) {
+        return fSubEvent_0;
+    }
+    return fUrgent;
+}
+#endif
@@ -1,7 +1,13 @@
 #include "SteppingAction.hh"
+#include "SensitiveDetector.hh"
 
 
 void SteppingAction::UserSteppingAction(const G4Step* step) {
+    if (Configuration::benchmark && run) {
+        run->CountStep();
+        if (!Configuration::saveSecondaries && !Configuration::savePhotons) return;
+    }
+
     const auto* post = step->GetPostStepPoint();
     const auto* postProc = post->GetProcessDefinedStep();
 
@@ -13,7 +19,7 @@ void SteppingAction::UserSteppingAction(const G4Step* step) {
     int copyNo = -1;
     if (touch && touch->GetVolume()) {
         volName = touch->GetVolume()->GetName();
-        copyNo = touch->GetVolume()->GetCopyNo();
+        copyNo = SensitiveDetector::VolumeID(touch);
     }
 
     const auto* track = step->GetTrack();
@@ -29,7 +35,7 @@ void SteppingAction::UserSteppingAction(const G4Step* step) {
                 const auto* cp = sc->GetCreatorProcess();
 
                 if (sc->GetDefinition()->GetParticleName() == "opticalphoton" and Configuration::savePhotons) {
-                    if (volName.find("CsICrystal_") != std::string::npos)
+                    if (volName == "CsICrystalPV")
                         ea->photonCountBuf[0] += 1;
                     if (volName == "ACShellPV")
                         ea->photonCountBuf[1] += 1;
@@ -0,0 +1,151 @@
+#include "ThresholdScan.hh"
+
+template <class T>
+static std::vector<T> SortedGrid(std::vector<T> grid) {
+    std::sort(grid.begin(), grid.end());
+    grid.erase(std::unique(grid.begin(), grid.end()), grid.end());
+    return grid;
+}
+
+ThresholdScan::ThresholdScan(std::vector<G4double> crystalMeV, std::vector<G4double> vetoMeV,
+                             std::vector<G4int> optCrystal, std::vector<G4int> optVeto, std::vector<G4int> optBottom,
+                             const G4int nBins, const G4bool useOptics)
+    : crystalGrid(SortedGrid(std::move(crystalMeV))),
+      vetoGrid(SortedGrid(std::move(vetoMeV))),
+      optCrystalGrid(SortedGrid(std::move(optCrystal))),
+      optVetoGrid(SortedGrid(std::move(optVeto))),
+      optBottomGrid(SortedGrid(std::move(optBottom))),
+      nBins(nBins),
+      useOptics(useOptics) {
+    if (crystalGrid.empty() || vetoGrid.empty()) {
+        G4Exception("ThresholdScan::ThresholdScan", "ThresholdScan", FatalException,
+                    "Threshold scan needs at least one crystal and one veto threshold");
+    }
+    if (useOptics && (optCrystalGrid.empty() || optVetoGrid.empty() || optBottomGrid.empty())) {
+        G4Exception("ThresholdScan::ThresholdScan", "ThresholdScan", FatalException,
+                    "Optical threshold scan needs at least one threshold per SiPM group");
+    }
+}
+
+void ThresholdScan::Register(G4AccumulableManager* mgr) {
+    const std::size_t nC = crystalGrid.size() + 1;
+    const std::size_t nV = vetoGrid.size() + 1;
+    const std::size_t nOpt = useOptics
+        ? (optCrystalGrid.size() + 1) * (optVetoGrid.size() + 1) * (optBottomGrid.size() + 1)
+        : 0;
+
+    // Registration keeps pointers, so the vectors must not reallocate afterwards.
+    energyHist.clear();
+    trigHist.clear();
+    optHist.clear();
+    energyHist.reserve(nC * nV);
+    trigHist.reserve(nV * nBins);
+    optHist.reserve(nOpt);
+
+    for (std::size_t i = 0; i < nC * nV; ++i) {
+        energyHist.emplace_back(0.0);
+        mgr->Register(energyHist.back());
+    }
+    for (std::size_t i = 0; i < nV * nBins; ++i) {
+        trigHist.emplace_back(0.0);
+        mgr->Register(trigHist.back());
+    }
+    for (std::size_t i = 0; i < nOpt; ++i) {
+        optHist.emplace_back(0.0);
+        mgr->Register(optHist.back());
+    }
+}
+
+void ThresholdScan::Fill(const ScanEvent& ev) {
+    const int kc = Passed(crystalGrid, ev.crystalEdepMax);
+    const int kv = Passed(vetoGrid, ev.vetoEdepMax);
+    const std::size_t nV = vetoGrid.size() + 1;
+
+    energyHist[kc * nV + kv] += 1.0;
+    if (ev.tof && ev.energyBin >= 0) {
+        trigHist[kv * nBins + ev.energyBin] += 1.0;
+    }
+
+    if (useOptics && ev.hasOptics) {
+        const int a = Passed(optCrystalGrid, ev.npeCrystal);
+        const int b = Passed(optVetoGrid, ev.npeVeto);
+        const int c = Passed(optBottomGrid, ev.npeBottom);
+        optHist[(a * (optVetoGrid.size() + 1) + b) * (optBottomGrid.size() + 1) + c] += 1.0;
+    }
+}
+
+// An event passes threshold j of a grid iff j < (number of thresholds it passes).
+//   crystal-only at (ic, iv):     kc > ic and kv <= iv
+//   crystal-and-veto at (ic, iv): kc > ic and kv > iv
+void ThresholdScan::Finalize(const std::vector<G4double>& genCounts, const G4double area) {
+    const std::size_t nC = crystalGrid.size();
+    const std::size_t nV = vetoGrid.size();
+
+    crystalOnly.assign(nC * nV, 0.0);
+    crystalAndVeto.assign(nC * nV, 0.0);
+
+    std::vector<G4double> below(nV, 0.0);  // running sum over kc > ic of events with kv <= iv
+    G4double rows = 0.0;                   // running sum over kc > ic of all events
+    for (std::size_t ic = nC; ic-- > 0;) {
+        const std::size_t kc = ic + 1;
+        G4double prefix = 0.0;
+        for (std::size_t kv = 0; kv <= nV; ++kv) {
+            const G4double h = energyHist[kc * (nV + 1) + kv].GetValue();
+            if (kv < nV) {
+                prefix += h;
+                below[kv] += prefix;
+            }
+            rows += h;
+        }
+        for (std::size_t iv = 0; iv < nV; ++iv) {
+            crystalOnly[ic * nV + iv] = below[iv];
+            crystalAndVeto[ic * nV + iv] = rows - below[iv];
+        }
+    }
+
+    effArea.assign(nV * nBins, 0.0);
+    std::vector<G4double> trig(nBins, 0.0);
+    for (std::size_t iv = 0; iv < nV; ++iv) {
+        for (G4int bin = 0; bin < nBins; ++bin) {
+            trig[bin] += trigHist[iv * nBins + bin].GetValue();
+            const G4double nGen = bin < static_cast<G4int>(genCounts.size()) ? genCounts[bin] : 0.0;
+            effArea[iv * nBins + bin] = nGen > 0.0 ? area * trig[bin] / nGen : 0.0;
+        }
+    }
+
+    if (!useOptics) return;
+
+    const std::size_t nA = optCrystalGrid.size();
+    const std::size_t nB = optVetoGrid.size();
+    const std::size_t nCb = optBottomGrid.size();
+    crystalOnlyOpt.assign(nA * nB * nCb, 0.0);
+    crystalAndVetoOpt.assign(nA * nB * nCb, 0.0);
+
+    std::vector<G4double> belowOpt(nB * nCb, 0.0);
+    std::vector<G4double> plane(nB * nCb);
+    G4double totalOpt = 0.0;
+    for (std::size_t ia = nA; ia-- > 0;) {
+        const std::size_t a = ia + 1;
+        // 2D prefix sum over (b <= ib, c <= ic) of this crystal slice.
+        for (std::size_t b = 0; b <= nB; ++b) {
+            for (std::size_t c = 0; c <= nCb; ++c) {
+                const G4double h = optHist[(a * (nB + 1) + b) * (nCb + 1) + c].GetValue();
+                totalOpt += h;
+                if (b < nB && c < nCb) plane[b * nCb + c] = h;
+            }
+        }
+        for (std::size_t b = 0; b < nB; ++b) {
+            for (std::size_t c = 0; c < nCb; ++c) {
+                G4double& p = plane[b * nCb + c];
+                if (b > 0) p += plane[(b - 1) * nCb + c];
+                if (c > 0) p += plane[b * nCb + c - 1];
+                if (b > 0 && c > 0) p -= plane[(b - 1) * nCb + c - 1];
+            }
+        }
+        for (std::size_t i = 0; i < nB * nCb; ++i) {
+            belowOpt[i] += plane[i];
+            crystalOnlyOpt[ia * nB * nCb + i] = belowOpt[i];
+            crystalAndVetoOpt[ia * nB * nCb + i] = totalOpt - belowOpt[i];
+        }
+    }
+}
@@ -0,0 +1,99 @@
+#include "TreeColumns.hh"
+
+static TreeColumns::Type TypeFromName(const std::string& typeName, const std::string& leafName) {
+    using Type = TreeColumns::Type;
+    if (typeName == "Char_t") return Type::I8;
+    if (typeName == "UChar_t" || typeName == "Bool_t") return Type::U8;
+    if (typeName == "Short_t") return Type::I16;
+    if (typeName == "UShort_t") return Type::U16;
+    if (typeName == "Int_t") return Type::I32;
+    if (typeName == "UInt_t") return Type::U32;
+    if (typeName == "Long64_t" || typeName == "Long_t") return Type::I64;
+    if (typeName == "ULong64_t" || typeName == "ULong_t") return Type::U64;
+    if (typeName == "Float_t") return Type::F32;
+    if (typeName == "Double_t") return Type::F64;
+    throw std::runtime_error("Unsupported leaf type " + typeName + " for column " + leafName);
+}
+
+TreeColumns::TreeColumns(TTree* t) : tree(t) {
+    auto* leaves = tree->GetListOfLeaves();
+    if (!leaves || leaves->GetEntries() == 0) {
+        throw std::runtime_error(std::string("No leaves found in tree: ") + tree->GetName());
+    }
+
+    const int nLeaves = leaves->GetEntries();
+    columns.reserve(nLeaves);
+    for (int i = 0; i < nLeaves; ++i) {
+        auto* leaf = static_cast<TLeaf*>(leaves->At(i));
+        const std::string name = leaf->GetName();
+
+        if (leaf->GetBranch()->GetListOfLeaves()->GetEntries() != 1) {
+            throw std::runtime_error("Leaf-list branch not supported: " + std::string(leaf->GetBranch()->GetName()));
+        }
+        if (leaf->GetLeafCount()) {
+            throw std::runtime_error("Variable-length leaf not supported: " + name);
+        }
+
+        Column c;
+        c.name = name;
+        if (leaf->InheritsFrom(TLeafC::Class())) {
+            c.type = Type::Str;
+            c.width = kMaxStringLen;
+            c.buffer.assign(kMaxStringLen, '\0');
+        } else {
+            c.type = TypeFromName(leaf->GetTypeName(), name);
+            c.width = std::max(1, leaf->GetLenStatic());
+            c.buffer.assign(Size(c.type) * c.width, '\0');
+        }
+        columns.push_back(std::move(c));
+    }
+
+    // Addresses are set on the tree (not the leaf) so a TChain keeps them across files.
+    tree->SetBranchStatus("*", false);
+    for (auto& c : columns) {
+        tree->SetBranchStatus(c.name.c_str(), true);
+        tree->SetBranchAddress(c.name.c_str(), c.buffer.data());
+    }
+}
+
+TreeColumns::~TreeColumns() {
+    tree->ResetBranchAddresses();
+}
+
+std::size_t TreeColumns::Size(const Type t) {
+    switch (t) {
+    case Type::I8:
+    case Type::U8:
+    case Type::Str:
+        return 1;
+    case Type::I16:
+    case Type::U16:
+        return 2;
+    case Type::I32:
+    case Type::U32:
+    case Type::F32:
+        return 4;
+    case Type::I64:
+    case Type::U64:
+    case Type::F64:
+        return 8;
+    }
+    return 0;
+}
+
+const char* TreeColumns::Name(const Type t) {
+    switch (t) {
+    case Type::I8: return "i8";
+    case Type::U8: return "u8";
+    case Type::I16: return "i16";
+    case Type::U16: return "u16";
+    case Type::I32: return "i32";
+    case Type::U32: return "u32";
+    case Type::I64: return "i64";
+    case Type::U64: return "u64";
+    case Type::F32: return "f32";
+    case Type::F64: return "f64";
+    case Type::Str: return "str";
+    }
+    return "unknown";
+}
@@ -78,6 +78,32 @@ G4double Utils::GetOr(const ConstMap& m, const std::string& key, G4double def) {
     return it == m.end() ? def : it->second;
 }
 
+std::string Utils::HashHex(const std::string& s) {
+    std::uint64_t h = 0xcbf29ce484222325ULL;
+    for (const unsigned char c : s) {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+    std::ostringstream hex;
+    hex << std::hex << std::setw(16) << std::setfill('0') << h;
+    return hex.str();
+}
+
+void Utils::DeriveSeeds(const std::uint64_t base, const std::uint64_t stream, long seeds[3]) {
+    std::uint64_t state = base * 0x9e3779b97f4a7c15ULL + stream;
+    auto next = [&state]() {
+        std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    };
+
+    // Valid Ranecu seed ranges are [1, 2147483562] and [1, 2147483398].
+    seeds[0] = static_cast<long>(1 + next() % 2147483562ULL);
+    seeds[1] = static_cast<long>(1 + next() % 2147483398ULL);
+    seeds[2] = 0;
+}
+
 G4double Utils::UnitFactor(const std::string& unitToken) {
     if (unitToken.empty() || unitToken == "-") return 1.0;
 